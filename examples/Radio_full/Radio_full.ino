@@ -16,9 +16,7 @@
 //-------------------------------------------------------------------------------------------------------------
 
 // EEPROM Usage Map
-#define eeprom_chn_msb  1
-#define eeprom_chn_lsb  2
-#define eeprom_vol      3
+#define eeprom_stations 0   // Station table: favourites, last channel and volume
 
 // Used Pins
 #define LED1        5       // LED1 pin
@@ -33,17 +31,11 @@
 // Variables
 //-------------------------------------------------------------------------------------------------------------
 
-// Favourate Channels fav_0..fav_9 (kHz)
-int       fav_0 = 8760;   
-int       fav_1 = 8820;   
-int       fav_2 = 9140;  
-int       fav_3 = 9220;   
-int       fav_4 = 9390;  
-int       fav_5 = 9440;   
-int       fav_6 = 9500;  
-int       fav_7 = 9760;   
-int       fav_8 = 10480;  
-int       fav_9 = 10740;   
+// Default Favourate Channels 0..9 (kHz), used until a station table is saved to EEPROM
+int       fav[10] = { 8760, 8820, 9140, 9220, 9390, 9440, 9500, 9760, 10480, 10740 };
+
+// Station table with favourites, last channel and volume
+Si4703_Stations stations;
 
 //-------------------------------------------------------------------------------------------------------------
 // Volatile variables for use in Rotary Encoder Interrupt Routine
@@ -68,8 +60,12 @@ void setup()
   pinMode(LED1, OUTPUT);      // LED1 pin is output
   digitalWrite(LED1, LOW);    // turn LED1 OFF
 
-  radio.start();              // start radio device
-  read_EEPROM();              // load saved settings
+  read_EEPROM();              // load saved settings, available before the radio starts
+  if (!radio.warmStart())     // adopt the running radio after an MCU only reset, else start it
+    {
+      radio.setChannel(stations.getLast());   // tune to last channel
+      radio.setVolume(stations.getVolume());  // restore volume
+    }
 
   // Enable rotary encoder
   pinMode(rotaryPinA, INPUT_PULLUP);         // pin is input and pulled high
@@ -93,6 +89,7 @@ void setup()
 void loop()
 {
 
+  radio.poll();                             // Advance seek in progress, calls seekDone() when complete
   if (rotaryUpdated)      updateChannel();  // Interrupt tells us to update the station when updateStation=True
   if (Serial.available()) processCommand(); // Radio control from serial interface
 
@@ -102,29 +99,23 @@ void loop()
 //-------------------------------------------------------------------------------------------------------------
 void write_EEPROM()
 {
-  // Save current channel value
-  int chan = radio.getChannel();      // get the current channel
-  int msb = chan >> 8;                // move channel over 8 spots to grab MSB
-  int lsb = chan & 0x00FF;            // clear the MSB, leaving only the LSB
-  EEPROM.write(eeprom_chn_msb, msb);  // write each byte to a single 8-bit position
-  EEPROM.write(eeprom_chn_lsb, lsb);
-
-  // Save volume
-  EEPROM.write(eeprom_vol, radio.getVolume());
-  
+  stations.setLast(radio.getChannel());   // Save current channel value
+  stations.setVolume(radio.getVolume());  // Save volume
+  stations.save(EEPROM, eeprom_stations); // Only changed bytes are written
 }
 //-------------------------------------------------------------------------------------------------------------
 // Read settings from EEPROM
 //-------------------------------------------------------------------------------------------------------------
 void read_EEPROM()
 {
-  // Read channel value
-  int MSB = EEPROM.read(eeprom_chn_msb);  // load the msb into one 8-bit register
-  int LSB = EEPROM.read(eeprom_chn_lsb);  // load the lsb into one 8-bit register
-  radio.setChannel((MSB << 8)|LSB);       // concatenate the lsb and msb
-  
-  // Read Volume
-  radio.setVolume(EEPROM.read(eeprom_vol));
+  stations.setRegion(BAND_US_EU, SPACE_100KHz, DE_75us);  // Same region as radio, other tables are rejected
+
+  if (!stations.load(EEPROM, eeprom_stations))            // Missing, corrupt or other region: use defaults
+    {
+      for (int i = 0; i < 10; i++) stations.add(fav[i]);
+      stations.setLast(fav[0]);
+      stations.setVolume(1);
+    }
 }
 //-------------------------------------------------------------------------------------------------------------
 // Interrupt handler that reads the encoder. It set the updateStation flag when a new indent is found 
@@ -153,6 +144,23 @@ void updateRotary()
 
 }
 //-------------------------------------------------------------------------------------------------------------
+// Called by radio.poll() when a seek started with radio.beginSeek() completes
+//-------------------------------------------------------------------------------------------------------------
+void seekDone(int freq, bool sfbl)
+{
+  if (sfbl)
+    {
+      Serial.println("| Error: Seek failure or band limit reached!!");
+    }
+  else
+    {
+      write_EEPROM();                    // Save channel to EEPROM
+      printCurrentSettings();
+    }
+  digitalWrite(LED1, HIGH);          // When done turn LED1 On
+  radio.writeGPIO(GPIO1, GPIO_High); // turn LED2 ON
+}
+//-------------------------------------------------------------------------------------------------------------
 // Update Channel Freq
 //-------------------------------------------------------------------------------------------------------------
 void updateChannel()
@@ -231,53 +239,44 @@ void printCurrentSettings()
    Serial.println(" |");
 }
 
+//-------------------------------------------------------------------------------------------------------------
+// Listen for RDS data up to 5 seconds and display it.
+//-------------------------------------------------------------------------------------------------------------
+void printRDS()
+{
+  Serial.println("| Listening for RDS...");
+
+  unsigned long start = millis();
+  while ((millis() - start < 5000) && !(radio.rds.hasPS() && radio.rds.hasRT()))
+    {
+      radio.readRDS();            // Decode one group
+      delay(20);                  // Groups arrive every ~88ms
+    }
+
+  Serial.print("| PI:0x");
+  Serial.print(radio.rds.getPI(), HEX);
+  Serial.print(" | PTY:");
+  Serial.print(radio.rds.getPTY());
+  Serial.print(" | PS:");
+  Serial.print(radio.rds.getPS());
+  Serial.println(" |");
+  Serial.print("| RT:");
+  Serial.println(radio.rds.getRT());
+}
 //-------------------------------------------------------------------------------------------------------------
 // Prints Favourite Stations List
 //-------------------------------------------------------------------------------------------------------------
 void printFavouriteList()
 {
   Serial.println("List of Favourite Stations");
-  
-  Serial.print("0 - ");
-  Serial.print(float(fav_0)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("1 - ");
-  Serial.print(float(fav_1)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("2 - ");
-  Serial.print(float(fav_2)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("3 - ");
-  Serial.print(float(fav_3)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("4 - ");
-  Serial.print(float(fav_4)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("5 - ");
-  Serial.print(float(fav_5)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("6 - ");
-  Serial.print(float(fav_6)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("7 - ");
-  Serial.print(float(fav_7)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("8 - ");
-  Serial.print(float(fav_8)/100,2);
-  Serial.println(" MHz");
-
-  Serial.print("9 - ");
-  Serial.print(float(fav_9)/100,2);
-  Serial.println(" MHz");
 
+  for (int i = 0; i < stations.count(); i++)
+    {
+      Serial.print(i);
+      Serial.print(" - ");
+      Serial.print(float(stations.getFreq(i))/100,2);
+      Serial.println(" MHz");
+    }
 }
 
 //-------------------------------------------------------------------------------------------------------------
@@ -364,97 +363,24 @@ void processCommand()
     {
       digitalWrite(LED1, LOW);           // turn LED1 OFF
       radio.writeGPIO(GPIO1, GPIO_Low);  // turn LED2 OFF
-      if (!radio.seekUp()) 
-        {
-          Serial.println("| Error: Seek failure or band limit reached!!");
-        }
-      else
-        {
-          write_EEPROM();                    // Save channel to EEPROM
-          printCurrentSettings();
-        }
-      digitalWrite(LED1, HIGH);          // When done turn LED1 On
-      radio.writeGPIO(GPIO1, GPIO_High); // turn LED2 ON
+      radio.beginSeek(Si4703::SEEK_UP, seekDone); // seekDone() is called from loop() when complete
     } 
   else if (ch == 'l')             // Channel Seek last
     {
       digitalWrite(LED1, LOW);           // turn LED1 OFF
       radio.writeGPIO(GPIO1, GPIO_Low);  // turn LED2 OFF
-      if (!radio.seekDown())
-        {
-          Serial.println("| Error: Seek failure or band limit reached!!");
-        }
-      else
-        {
-          write_EEPROM();                    // Save channel to EEPROM
-          printCurrentSettings();
-        }
-      digitalWrite(LED1, HIGH);          // When done turn LED1 On
-      radio.writeGPIO(GPIO1, GPIO_High); // turn LED2 ON
+      radio.beginSeek(Si4703::SEEK_DOWN, seekDone); // seekDone() is called from loop() when complete
     } 
-  else if (ch == '0')             // Tune to favorite channel 0
-    {
-      radio.setChannel(fav_0);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '1')             // Tune to favorite channel 1
-    {
-      radio.setChannel(fav_1);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '2')             // Tune to favorite channel 2
-    {
-      radio.setChannel(fav_2);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '3')             // Tune to favorite channel 3
-    {
-      radio.setChannel(fav_3);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '4')             // Tune to favorite channel 4
-    {
-      radio.setChannel(fav_4);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '5')             // Tune to favorite channel 5
-    {
-      radio.setChannel(fav_5);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '6')             // Tune to favorite channel 6
-    {
-      radio.setChannel(fav_6);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '7')             // Tune to favorite channel 7
-    {
-      radio.setChannel(fav_7);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '8')             // Tune to favorite channel 8
-    {
-      radio.setChannel(fav_8);
-      write_EEPROM();             // Save channel to EEPROM
-      printCurrentSettings();
-    }
-  else if (ch == '9')             // Tune to favorite channel 9
+  else if (ch >= '0' && ch <= '9') // Tune to favorite channel 0..9
     {
-      radio.setChannel(fav_9);
+      if (ch - '0' >= stations.count()) return;   // No such favourite
+      radio.setChannel(stations.getFreq(ch - '0'));
       write_EEPROM();             // Save channel to EEPROM
       printCurrentSettings();
     }
   else if (ch == 'r')             // Listen for RDS Data
     {
-      // TODO:
+      printRDS();
     }
   else if (ch == 'i')             // Print current settings
     {
@@ -0,0 +1,42 @@
+#include <Si4703.h>
+#include <Wire.h>
+
+#define MAX_STATIONS  30
+
+Si4703    radio;                    // using default values for all settings
+station_t stations[MAX_STATIONS];   // Scan results
+
+void setup()
+{
+  Serial.begin(115200);   // start serial
+  radio.start();          // Power Up Device
+  radio.setChannel(9440); // Set frequency 94.4 Mhz
+  radio.setVolume(1);     // Set volume
+
+  Serial.println("\nSeek scan:");
+  printStations(radio.scanBand(stations, MAX_STATIONS, SCAN_SEEK));
+
+  Serial.println("\nStep scan:");
+  printStations(radio.scanBand(stations, MAX_STATIONS, SCAN_STEP));
+}
+
+void loop()
+{
+}
+
+void printStations(int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    Serial.print(float(stations[i].freq)/100,2);
+    Serial.print(" MHz | RSSI:");
+    Serial.print(stations[i].rssi);
+    Serial.print(" | ST:");
+    Serial.println(stations[i].st);
+  }
+
+  Serial.print(count);
+  Serial.print(" stations in ");
+  Serial.print(radio.getScanTime());
+  Serial.println(" ms");
+}
@@ -7,23 +7,15 @@
 #define Si4703_h
 
 #include "Arduino.h"
+#include "Si4703_Bus.h"
+#include "Si4703_Monitor.h"
+#include "Si4703_Region.h"
+#include "Si4703_RDS.h"
+#include "Si4703_RDSStats.h"
+#include "Si4703_Stations.h"
 
 //------------------------------------------------------------------------------------------------------------
 
-// Band Select
-static const uint8_t  	BAND_US_EU		= 0b00;	// 87.5–108 MHz (US / Europe, Default)
-static const uint8_t  	BAND_JPW		= 0b01;	// 76–108 MHz (Japan wide band)
-static const uint8_t  	BAND_JP			= 0b10;	// 76–90 MHz (Japan)
-
-// De-emphasis
-static const uint8_t	DE_75us			= 0b0;	// De-emphasis 75 μs. Used in USA (default)
-static const uint8_t	DE_50us			= 0b1;	// De-emphasis 50 μs. Used in Europe, Australia, Japan.
-
-// Channel Spacing
-static const uint8_t  	SPACE_200KHz	= 0b00;	// 200 kHz (US / Australia, Default)
-static const uint8_t  	SPACE_100KHz 	= 0b01;	// 100 kHz (Europe / Japan)
-static const uint8_t  	SPACE_50KHz  	= 0b10;	//  50 kHz (Other)
-
 // GPIO1-3 Pins
 static const uint8_t  	GPIO1			= 1;	// GPIO1
 static const uint8_t  	GPIO2			= 2;	// GPIO2
@@ -67,27 +59,125 @@ static const uint8_t 	BLA_37_55		= 0b01;	// 37–55 RSSI dBμV (+6 dB)
 static const uint8_t 	BLA_19_37		= 0b10;	// 19–37 RSSI dBμV (–12 dB)
 static const uint8_t 	BLA_25_43		= 0b11;	// 25–43 RSSI dBμV (–6 dB)
 
+// Band Scan Mode
+static const uint8_t 	SCAN_SEEK		= 0;	// Hardware seek from station to station
+static const uint8_t 	SCAN_STEP		= 1;	// Tune every channel and sample RSSI
+
+// RDS interrupt capture queue length in groups, must be a power of 2 (12 bytes RAM each)
+#ifndef SI4703_RDS_QUEUE_LEN
+#define SI4703_RDS_QUEUE_LEN	8
+#endif
+
+// RDS interrupt capture reads the group inside the GPIO2 ISR, with interrupts enabled again for Wire. Only AVR
+// cores allow that, elsewhere (0) the ISR flags the group and readRDS()/readGroup()/getGroupCount()/poll() read it.
+#ifndef SI4703_ISR_BUS
+#if defined(__AVR__)
+#define SI4703_ISR_BUS			1
+#else
+#define SI4703_ISR_BUS			0
+#endif
+#endif
+
+// Bus traffic and blocking time statistics, 0 removes them (and their RAM) from the build
+#ifndef SI4703_STATS
+#define SI4703_STATS			1
+#endif
+
+// Blocking API index for si4703Stats_t.blockUs
+static const uint8_t	STATS_START		= 0;	// start()
+static const uint8_t	STATS_WARMSTART	= 1;	// warmStart()
+static const uint8_t	STATS_POWERUP	= 2;	// powerUp()
+static const uint8_t	STATS_POWERDOWN	= 3;	// powerDown()
+static const uint8_t	STATS_TUNE		= 4;	// setChannel(), incChannel(), decChannel()
+static const uint8_t	STATS_SEEK		= 5;	// seekUp(), seekDown()
+static const uint8_t	STATS_SCAN		= 6;	// scanBand()
+static const uint8_t	STATS_RESUME	= 7;	// resume()
+static const uint8_t	STATS_API_COUNT	= 8;
+
+//------------------------------------------------------------------------------------------------------------
+// Bus traffic and blocking time counters, see getStats()
 //------------------------------------------------------------------------------------------------------------
+struct si4703Stats_t
+{
+	uint32_t	getShadow;					// Full register set reads (32 bytes)
+	uint32_t	putShadow;					// Register writes
+	uint32_t	readStatus;					// Partial status register reads (2-16 bytes)
+	uint32_t	rdsCaptures;				// RDS groups read by the interrupt capture (12 bytes)
+	uint32_t	bytesRead;					// Bytes read, all of the above
+	uint32_t	bytesWritten;				// Bytes written
+	uint32_t	writeErrors;				// Wire.endTransmission() results other than 0
+	uint32_t	stcPolls;					// STC reads over the bus while waiting for tune/seek
+	uint32_t	retries;					// Bus operations repeated after a failure
+	uint32_t	timeouts;					// Tune/seek/power up that didn't complete in time
+	uint32_t	tunes;						// Tunes completed (blocking and async)
+	uint32_t	seeks;						// Seeks completed (blocking and async)
+	uint32_t	tuneUs;						// Time from start to completion of those tunes (us)
+	uint32_t	seekUs;						// Time from start to completion of those seeks (us)
+	uint32_t	blockUs[STATS_API_COUNT];	// Time spent blocked per API (us), nested calls count for the outer one
+};
 
-class Si4703
+//------------------------------------------------------------------------------------------------------------
+// Si4703 driver over a bus transport Bus (see Si4703_Bus.h), resolved at compile time without virtual calls:
+//   Si4703                   radio;                                  // Wire (most sketches)
+//   Si4703T<Si4703_TwoWire>  radio(Si4703_TwoWire(Wire1, SDA1));     // Another I2C peripheral
+//   Si4703T<Si4703_3Wire>    radio(Si4703_3Wire(SEN, SDIO, SCLK));   // 3-wire, off the I2C bus
+// and a region policy Region (see Si4703_Region.h), by default selected at runtime by the constructor:
+//   Si4703_Fixed<BAND_US_EU, SPACE_100KHz, DE_75us>  radio;         // Band fixed at compile time
+//------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region = Si4703_RuntimeRegion>
+class Si4703T
 {
 //------------------------------------------------------------------------------------------------------------
   public:
-    Si4703(	                
+	typedef void (*tuneCallback_t)(int freq, bool sfbl);	// Async tune/seek completion: channel and Seek Fail/Band Limit
+	typedef bool (*seekProgress_t)(int freq);				// Seek progress: channel examined, return false to abort
+
+	static const uint16_t  	SEEK_DOWN 		= 0; 	// Direction used for seeking. Default is down
+	static const uint16_t  	SEEK_UP 		= 1;
+
+	// Error codes, see getError()
+	static const uint8_t	ERR_NONE		= 0;	// Success
+	static const uint8_t	ERR_BUS			= 1;	// No acknowledge from the device after all retries
+	static const uint8_t	ERR_TIMEOUT		= 2;	// Tune/seek/power up didn't complete in time
+	static const uint8_t	ERR_DEVICE		= 3;	// The device on the bus is not a Si4703
+	static const uint8_t	ERR_STATE		= 4;	// restoreState() blob invalid, of another version or another fixed region
+
+	// Configuration blob, see saveState()
+	static const uint8_t	STATE_VERSION	= 1;	// Blob format version
+	static const uint8_t	STATE_SIZE		= 14;	// Blob size in bytes
+
+    Si4703T(	                
 				// MCU Pins Selection
                 int rstPin  = 4,            // Reset Pin
 				int sdioPin = A4,           // I2C Data IO Pin
-				int sclkPin = A5,           // I2C Clock Pin
+				int /*sclkPin*/ = A5,       // I2C Clock Pin, unused: SCL is fixed by Wire
 				int intPin  = 0,	        // Seek/Tune Complete and RDS interrupt Pin
 
                 // Band Settings
 				int band    = BAND_US_EU,	// Band Range
                 int space   = SPACE_100KHz,	// Band Spacing
                 int de      = DE_75us,		// De-Emphasis
-                
-                // RDS Settings
 
-                // Tune Settings
+                // Seek Settings
+				int skmode  = SKMODE_STOP,	// Seek Mode
+				int seekth  = 24,	        // Seek Threshold
+				int skcnt 	= SKSNR_MAX,    // Seek Clicks Number Threshold
+				int sksnr	= SKCNT_MIN,    // Seek Signal/Noise Ratio
+                int agcd	= 0				// AGC disable
+    		) : Si4703T(Bus(sdioPin), rstPin, intPin, band, space, de, skmode, seekth, skcnt, sksnr, agcd) {}
+
+    Si4703T(	                
+				// Bus
+				const Bus &bus,				// Transport, e.g. Si4703_3Wire(SEN, SDIO, SCLK)
+
+				// MCU Pins Selection
+                int rstPin  = 4,            // Reset Pin
+				int intPin  = 0,	        // Seek/Tune Complete and RDS interrupt Pin
+
+                // Band Settings
+				int band    = BAND_US_EU,	// Band Range
+                int space   = SPACE_100KHz,	// Band Spacing
+                int de      = DE_75us,		// De-Emphasis
 
                 // Seek Settings
 				int skmode  = SKMODE_STOP,	// Seek Mode
@@ -96,10 +186,28 @@ class Si4703
 				int sksnr	= SKCNT_MIN,    // Seek Signal/Noise Ratio
                 int agcd	= 0				// AGC disable
     		);
+	~Si4703T();						// Releases the GPIO2 interrupt if this instance has it
 		
-    	void	powerUp();				// Power Up radio device
-	void	powerDown();				// Power Down radio device to save power
-	void 	start();				// start radio
+	byte	powerUp();				// Power Up radio device, returns ERR_xxx
+	byte	powerDown();				// Power Down radio device to save power, returns ERR_xxx
+	byte 	start();				// start radio, returns ERR_xxx
+	bool	warmStart();			// Adopt a running device without reset, else start(). Returns true if adopted
+	byte	sleep(void);			// Power down keeping the register state for resume(), returns ERR_xxx
+	byte	resume(void);			// Restore the state before sleep() in one write and retune, returns ERR_xxx
+	bool	isAsleep(void);			// Returns true between sleep() and resume()
+	void	setIdleTimeout(unsigned long ms);	// sleep() from poll() after ms without a register write, 0=never (default)
+	byte	saveState(uint8_t *buf);	// Save registers 0x02-0x07 and the channel to buf[STATE_SIZE], returns ERR_xxx
+	byte	restoreState(const uint8_t *buf);	// Apply a saveState() blob in one write and at most one tune, returns ERR_xxx
+	void	setOscillator(bool xtal,			// 1=Crystal (default), 0=External clock on RCLK
+						  unsigned int settle = 500);	// Oscillator settle time on power up (ms), call before start()
+	bool	setInterrupt(bool en);	// 1=Wait for Seek/Tune Complete on intPin (GPIO2) instead of polling, call after start()
+	bool	setRDSInterrupt(bool en);	// 1=Capture every RDS group from the intPin (GPIO2) interrupt, call after start()
+									// Only one instance per Si4703T<Bus, Region> type can use the interrupt
+
+	void	setTimeout(unsigned int tuneMs,	// Max tune time (default 250ms)
+					   unsigned int seekMs);	// Max seek time (default 15000ms)
+	void	setRetries(byte tries);	// Attempts per bus operation (default 10)
+	byte	getError(void);			// Get and clear the last error (ERR_xxx)
 
 	int		getPN();				// Get DeviceID:Part Number
 	int		getMFGID();				// Get DeviceID:Manufacturer ID
@@ -112,15 +220,54 @@ class Si4703
 	int		getBandSpace();			// Get Band Spacing
 
 	int		getRSSI(void);			// Get RSSI current value
+	byte	readSignal(signal_t &s);	// Get RSSI, ST, RDSS, AFCRL and channel in one 4 byte read, returns ERR_xxx
 
-	int 	getChannel(void);		// Get 3 digit channel number
+	int 	getChannel(void);		// Get 3 digit channel number, 0 on a bus error
 	int		setChannel(int freq);	// Set 3 digit channel number
+	template <int FREQ>
+	int		setChannel(void)		// Set a constant channel, checked against a fixed region at compile time
+			{ return setChannel(Region::template Freq<FREQ>::value); }
 	int		incChannel(void);		// Increment Channel Frequency one band step
 	int		decChannel(void);		// Decrement Channel Frequency one band step
 	
+	uint16_t getPresetWord(int freq);	// Get the CHAN word of a channel (clamped to the band) for tunePreset()
+	int		tunePreset(uint16_t chan,		// Tune a precomputed CHAN word, returns the channel or 0
+					   bool verify = false);	// 1=Read back STC and channel like setChannel()
+
 	int 	seekUp(void); 			// Seeks up and returns the tuned channel or 0
 	int 	seekDown(void); 		// Seeks down and returns the tuned channel or 0
 
+	bool	beginTune(int freq,					// Start tuning without waiting
+					  tuneCallback_t done = NULL);	// called with channel when complete
+	bool	beginPreset(uint16_t chan,			// Start tuning a CHAN word from getPresetWord() without waiting
+						tuneCallback_t done = NULL,	// called with channel when complete
+						bool verify = false);		// 1=Read back STC and channel like beginTune()
+	bool	beginSeek(byte seekDirection,		// Start seeking SEEK_UP/SEEK_DOWN without waiting
+					  tuneCallback_t done = NULL);	// called with channel and SFBL when complete
+	bool	poll(void);				// Advance async tune/seek, call from loop(). Returns true while busy
+	bool	isBusy(void);			// Returns true while async tune/seek is in progress
+	void	cancel(void);			// Abort async tune/seek
+	void	setSeekProgress(seekProgress_t cb);	// Report the channel examined while seeking (once per channel), NULL = off
+	int		getSeekProgress(void);	// Get the channel examined by the last progress report, 0 if none
+	unsigned long getTuneEstimate(void);	// Get the learned tune time (us), the first STC poll is due then
+	unsigned long getSeekEstimate(void);	// Get the learned seek time per channel (us), STC is polled once per channel
+	bool	getTuned(station_t &s);	// Get channel, RSSI and ST of the last async tune/seek, false if it failed
+	int		getSeekThreshold(void);	// Get seek RSSI threshold (SEEKTH)
+
+	int		scanBand(station_t *list,		// Scan the whole band into list, returns number of stations
+					 int maxStations,		// list size
+					 uint8_t mode = SCAN_SEEK,	// SCAN_SEEK or SCAN_STEP
+					 unsigned int piWait = 0);	// ms to wait for RDS PI on each station, 0 = skip
+	unsigned long getScanTime(void);	// Get duration of last scanBand() in ms
+	void	setScanning(bool en);	// Mute and stop seeks at the band limit (true), restore both (false), written by the next tune
+
+	bool	checkAF(int freq,				// Tune to an Alternative Frequency muted, stay if it carries pi, else return
+					uint16_t pi,			// Program Identification to confirm
+					uint8_t minRSSI,		// Lowest RSSI worth waiting for the PI
+					unsigned int window,	// Max ms to wait for the PI
+					uint8_t &rssi);			// RSSI on freq
+	unsigned long getAFTime(void);	// Get ms off the original channel during the last checkAF()
+
 	void	setMono(bool en);		// 1=Force Mono
 	bool	getMono(void);			// Get Mono status
 	bool	getST(void);			// Get Sterio Status
@@ -134,26 +281,36 @@ class Si4703
 	int		incVolume(void);		// Increment Volume
 	int		decVolume(void);		// Decrement Volume
 
-	void	readRDS(void);			// Reads RDS, message should be at least 9 chars, result will be null terminated.
+	bool	readRDS(void);			// Read and decode one RDS group into rds, returns true if a new group was accepted
+	Si4703_RDS	rds;				// Decoded RDS data (PI, PTY, TP/TA, PS, RadioText, Clock Time)
+	bool	readGroup(rdsGroup_t &g);	// Read one raw group captured by the RDS interrupt, returns false if none
+	int		getGroupCount(void);		// Get number of captured groups waiting in the queue
+	uint16_t getRDSOverflow(void);		// Get number of groups lost because the queue was full
+	void	setRDSStats(Si4703_RDSStats *stats);	// Collect RDS reception statistics per channel into stats, NULL = off
 
 	void	writeGPIO(int GPIO, 	// Write to GPIO1,GPIO2, and GPIO3
 					  int val); 	// values can be GPIO_Z, GPIO_I, GPIO_Low, and GPIO_High
 
+	int		getWriteBytes(void);	// Get number of bytes sent by the last register write (0, 2-12)
+
+	void	beginUpdate(void);		// Start transaction: setters only change the shadow
+	byte	commit(void);			// End transaction: write all changes in one register write
+
+	bool	getStats(si4703Stats_t &stats,	// Copy statistics, false if built with SI4703_STATS 0
+					 bool reset = false);	// 1=Reset them in the same step
+	void	resetStats(void);		// Reset statistics
+
 //------------------------------------------------------------------------------------------------------------
   private:
+	// Bus
+	Bus	_bus;					// Transport (2-wire or 3-wire)
+
     // MCU Pins Selection
 	int _rstPin;				// Reset Pin
-	int _sdioPin;				// I2C Data IO Pin
-	int _sclkPin;				// I2C Clock Pin
 	int _intPin;				// Seek/Tune Complete and RDS interrupt Pin
 
 	// Band Settings
-	int _band;					// Band Range code
-  	int _space;					// Band Spacing code
-  	int _de;					// De-Emphasis
-	int	_bandStart;				// Bottom of Band (MHz)
-	int	_bandEnd;				// Top of Band (MHz)
-	int	_bandSpacing;			// Band Spacing (MHz)
+	Region	_region;			// Band Range, Spacing and De-Emphasis
 
 	// RDS Settings
 
@@ -167,22 +324,149 @@ class Si4703
 	int _agcd;					// AGC disable
 
 	// Private Functions
-	void	getShadow();		// Read registers to shadow 
+	byte	getShadow();		// Read all registers to shadow (primes the cache)
+	byte	readStatus(uint8_t words = 6);	// Read first words of status/RDS (0x0A-0x0F) and ID (0x00-0x01) registers to shadow
+	byte	readWords(uint16_t *w,	// Read words from 0x0A on with retries, w is only changed on success
+					  uint8_t words);
+	bool	isPoweredUp(void);	// CHIPID in shadow shows a powered up device
+	byte	waitPowerUp(void);	// Wait until powered up, max 110ms
+	byte	wake(void);			// Power up from sleep() with the register state in one write, no tune
+	static uint8_t stateSum(const uint8_t *buf);	// Check byte of a saveState() blob
 	byte 	putShadow();		// Write shadow to registers
-	void	bus3Wire(void);		// 3-Wire Control Interface (SCLK, SEN, SDIO)
-	void	bus2Wire(void);		// 2-Wire Control Interface (SCLCK, SDIO)
-	void	setRegion(int band,	// Band Range
-					  int space,// Band Spacing
-					  int de);	// De-Emphasis
+	byte 	updateShadow();		// Write shadow to registers unless in a transaction
 	bool	getSTC(void);		// Get STC status
+	bool	checkSTC(void);		// Check STC without blocking (interrupt or polling)
+	bool	checkSeek(void);	// Check STC and report seek progress, true if done or aborted
+	bool	pollDue(void);		// The next STC/status poll is due
+	void	pollNext(void);		// Schedule the next poll after one that didn't see the expected status
+	void	learnTune(unsigned long took);	// Update the tune time estimate
+	void	learnSeek(unsigned long took);	// Update the seek time per channel estimate
+	bool	asyncFail(byte err);	// End async tune/seek with an error
+	static void isrGPIO2(void);	// GPIO2 (STC/RDS) interrupt service routine
+	bool	setGPIO2Int(bool stcien,	// Configure GPIO2 interrupt sources
+						bool rdsien);
+	void	releaseISR(void);		// Detach the ISR if it serves this instance
+	void	captureRDS(bool isr);	// Read status/RDS registers and queue a ready group
+	void	busRelease(void);		// End of bus transaction, serve pending RDS capture
+	void	flushRDS(void);			// Drop captured RDS groups of the channel left
+	void	servePending(void);		// Capture an RDS group the ISR left pending, unless the bus is in use
+	bool	decodeRDS(const rdsGroup_t &g);	// Decode a group into rds and count it in the RDS statistics
 	int 	seek(byte seekDir);	// Seek next channel
 
-	// I2C interface
-	static const int  		I2C_ADDR		= 0x10; // I2C address of Si4703 - note that the Wire function assumes non-left-shifted I2C address, not 0b.0010.000W
+	// Bus interface
+	static const uint16_t	DEVICEID_SI4703	= 0x1242;	// DEVICEID of Si4703: PN=0x1, MFGID=0x242
 	static const uint16_t  	I2C_FAIL_MAX 	= 10; 	// This is the number of attempts we will try to contact the device before erroring out
-
-	static const uint16_t  	SEEK_DOWN 		= 0; 	// Direction used for seeking. Default is down
-	static const uint16_t  	SEEK_UP 		= 1;
+	static const unsigned int	TUNE_TIMEOUT	= 250;	// Default max tune time (ms), 60ms typical
+	static const unsigned int	SEEK_TIMEOUT	= 15000;// Default max seek time (ms), whole band
+	static const unsigned int	POWERUP_TIMEOUT	= 110;	// Max power up time (ms)
+	static const unsigned long	TUNE_US		= 60000;	// Initial tune time estimate (us)
+	static const unsigned long	SEEK_CHAN_US	= 30000;// Initial seek time per channel estimate (us)
+	static const unsigned long	POLL_MIN_US	= 250;		// First poll interval after the expected completion (us)
+	static const unsigned long	POLL_MAX_US	= 2000;		// Max poll interval after the expected completion (us)
+
+	// Register addresses
+	static const uint8_t	REG_DEVICEID	= 0x00;	// Static ID registers (cached)
+	static const uint8_t	REG_CHIPID		= 0x01;
+	static const uint8_t	REG_POWERCFG	= 0x02;	// Control registers (cached, written back when dirty)
+	static const uint8_t	REG_CHANNEL		= 0x03;
+	static const uint8_t	REG_SYSCONFIG1	= 0x04;
+	static const uint8_t	REG_SYSCONFIG2	= 0x05;
+	static const uint8_t	REG_SYSCONFIG3	= 0x06;
+	static const uint8_t	REG_TEST1		= 0x07;
+	static const uint8_t	REG_STATUSRSSI	= 0x0A;	// Volatile status/RDS registers (read on request)
+	static const uint8_t	REG_READCHAN	= 0x0B;
+	static const uint8_t	REG_RDSA		= 0x0C;
+	static const uint8_t	REG_RDSB		= 0x0D;
+	static const uint8_t	REG_RDSC		= 0x0E;
+	static const uint8_t	REG_RDSD		= 0x0F;
+
+	static const uint16_t	REG_CTRL_MASK	= 0x00FC;	// Dirty mask for all control registers 0x02-0x07
+
+	uint16_t	_dirty;					// Control registers changed in shadow but not yet written (bit n = register 0x0n)
+	byte		_busTries;				// Attempts per bus operation
+	unsigned int	_tuneTimeout;		// Max tune time (ms)
+	unsigned int	_seekTimeout;		// Max seek time (ms)
+	byte		_error;					// Last error, cleared by getError()
+	uint8_t		_writeBytes;			// Bytes sent by the last putShadow()
+	uint8_t		_updateDepth;			// Nesting depth of beginUpdate()/commit()
+
+	// Idle power down
+	bool			_asleep;			// Powered down by sleep(), the shadow holds the state to resume
+	uint16_t		_sleepChan;			// Channel before sleep()
+	unsigned long	_idleTimeout;		// sleep() after this many ms without a register write, 0 = never
+	unsigned long	_lastActive;		// Last register write or resume() (ms)
+
+	// Interrupt
+	static Si4703T*	_isrRadio;			// Instance served by isrGPIO2(), one per type, NULL = free
+	volatile bool	_stcInt;			// Set by isrGPIO2() on GPIO2 falling edge
+
+	// Async Tune/Seek
+	static const uint8_t	ASYNC_IDLE	= 0;	// Nothing in progress
+	static const uint8_t	ASYNC_TUNE	= 1;	// TUNE set, waiting for STC
+	static const uint8_t	ASYNC_SEEK	= 2;	// SEEK set, waiting for STC
+	static const uint8_t	ASYNC_CLEAR	= 3;	// TUNE/SEEK cleared, waiting for STC to clear
+
+	uint8_t			_asyncState;		// Async state
+	tuneCallback_t	_asyncDone;			// Completion callback
+	bool			_asyncVerify;		// Read back STC and channel after a tune
+	int				_asyncFreq;			// Last completed channel
+	bool			_asyncSFBL;			// Last seek failed or hit band limit
+	unsigned long	_asyncStart;		// Start of tune/seek (ms), for the timeout
+	unsigned long	_asyncUs;			// Start of tune/seek (us), for the poll schedule
+	unsigned long	_asyncTook;			// Time to STC of the tune/seek (us)
+	unsigned long	_pollAt;			// Next poll (us after _asyncUs)
+	unsigned long	_pollStep;			// Poll interval: back off for tune/clear, one channel for seek
+	unsigned long	_tuneUs;			// Learned tune time (us)
+	unsigned long	_seekChanUs;		// Learned seek time per channel (us)
+	int16_t			_seekFrom;			// READCHAN at the start of the seek, -1 for a tune
+	unsigned int	_asyncLimit;		// Timeout of the tune/seek in progress (ms)
+	seekProgress_t	_seekProgress;		// Seek progress callback
+	int				_seekFreq;			// Channel examined at the last progress report
+
+	// RDS
+	bool			_rdsrLast;			// RDSR was set at the last readRDS()
+	Si4703_RDSStats*	_rdsStats;		// RDS reception statistics, NULL = off
+
+	// RDS interrupt capture queue (single producer ISR, single consumer readGroup())
+	static const uint8_t	RDS_QUEUE_LEN	= SI4703_RDS_QUEUE_LEN;
+
+	rdsGroup_t		_rdsQueue[RDS_QUEUE_LEN];	// Captured groups
+	volatile uint8_t	_rdsHead;			// Next slot written by the ISR (free running)
+	volatile uint8_t	_rdsTail;			// Next slot read by readGroup() (free running)
+	volatile uint16_t	_rdsOverflow;		// Groups lost because the queue was full
+	volatile bool	_rdsPending;		// RDS interrupt came while the bus was in use
+	volatile bool	_busLock;			// Bus transaction in progress
+
+	// Scan
+	unsigned long	_scanTime;			// Duration of last scanBand() (ms)
+	bool			_scanDmute;			// DMUTE before setScanning(true)
+	bool			_scanSkmode;		// SKMODE before setScanning(true)
+
+	// Alternative Frequencies
+	unsigned long	_afTime;			// Time off channel in the last checkAF() (ms)
+
+	// Oscillator
+	bool			_xosc;				// Crystal oscillator, else external clock
+	unsigned int	_oscDelay;			// Oscillator settle time (ms)
+
+	// Statistics
+#if SI4703_STATS
+	static const uint8_t	STATS_API_NONE	= 0xFF;
+
+	si4703Stats_t	_stats;				// Counters
+	uint8_t			_statsApi;			// Outermost blocking API in progress
+
+	class StatsBlock					// Adds the time until it goes out of scope to blockUs[api]
+	{
+	  public:
+		StatsBlock(Si4703T &radio, uint8_t api);
+		~StatsBlock();
+	  private:
+		Si4703T			&_radio;
+		uint8_t			_api;
+		unsigned long	_start;
+	};
+#endif
 
 	// Registers shadow
 	//------------------------------------------------------------------------------------------------------------
@@ -419,4 +703,40 @@ class Si4703
 		} 			reg;
 	} shadow;							// There are 16 registers, each 16 bits large;
 };
+
+//------------------------------------------------------------------------------------------------------------
+// Si4703 on the Arduino Wire bus
+//------------------------------------------------------------------------------------------------------------
+typedef Si4703T<Si4703_Wire>	Si4703;
+
+//------------------------------------------------------------------------------------------------------------
+// Si4703 on the Arduino Wire bus with the region fixed at compile time
+//------------------------------------------------------------------------------------------------------------
+template <uint8_t BAND, uint8_t SPACE, uint8_t DE>
+using Si4703_Fixed = Si4703T<Si4703_Wire, Si4703_Region<BAND, SPACE, DE> >;
+
+//------------------------------------------------------------------------------------------------------------
+// Scoped configuration transaction: beginUpdate() on construction, commit() when it goes out of scope
+//   {
+//     Si4703_Update update(radio);
+//     radio.setVolume(5);
+//     radio.setMono(true);
+//   }                              // one register write here
+// Use Si4703_UpdateT<Si4703T<Bus> > for another transport.
+//------------------------------------------------------------------------------------------------------------
+template <class Radio>
+class Si4703_UpdateT
+{
+  public:
+	Si4703_UpdateT(Radio &radio) : _radio(radio)	{ _radio.beginUpdate(); }
+	~Si4703_UpdateT()								{ _radio.commit(); }
+
+  private:
+	Radio	&_radio;
+};
+
+typedef Si4703_UpdateT<Si4703>	Si4703_Update;
+
+#include "Si4703_impl.h"
+
 #endif
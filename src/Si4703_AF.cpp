@@ -0,0 +1,185 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  RDS Alternative Frequency following for Si4703
+ *  Tables are fixed size (SI4703_AF_PROGRAMS programs of Si4703_RDS::AF_MAX AFs), no heap.
+ */
+
+#include "Arduino.h"
+#include "Si4703_AF.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_AF Class Initialization
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_AF::Si4703_AF()
+{
+  _enabled   = false;
+  _threshold = 20;
+  _margin    = 6;
+  _window    = 200;       // PI usually arrives within 2 groups (176ms)
+  _holdOff   = 10000;
+  _maxChecks = 2;
+  clear();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Forget all tables and statistics
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_AF::clear(void)
+{
+  memset(_table, 0, sizeof(_table));
+  _pi        = 0;
+  _freq      = 0;
+  _merged    = 0;
+  _lastRound = 0;
+  _rounds    = false;
+  _offTime   = 0;
+  _lastOff   = 0;
+  _checks    = 0;
+  _switches  = 0;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Settings
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_AF::enable(bool en)
+{
+  _enabled = en;
+}
+
+bool Si4703_AF::isEnabled(void)
+{
+  return _enabled;
+}
+
+void Si4703_AF::setThreshold(uint8_t rssi)
+{
+  _threshold = rssi;
+}
+
+void Si4703_AF::setMargin(uint8_t rssi)
+{
+  _margin = rssi;
+}
+
+void Si4703_AF::setWindow(unsigned int ms)
+{
+  _window = ms;
+}
+
+void Si4703_AF::setHoldOff(unsigned int ms)
+{
+  _holdOff = ms;
+}
+
+void Si4703_AF::setMaxChecks(uint8_t n)
+{
+  _maxChecks = n;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Table of pi, or NULL if none. With add a missing table is created in place of a free or the oldest one.
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_AF::afTable_t* Si4703_AF::table(uint16_t pi, bool add)
+{
+  afTable_t *old = &_table[0];
+  for (uint8_t i = 0; i < SI4703_AF_PROGRAMS; i++)
+    {
+      if (_table[i].pi == pi) return &_table[i];
+      if (_table[i].pi == 0 || (old->pi != 0 && _table[i].used < old->used)) old = &_table[i];
+    }
+  if (!add) return NULL;
+
+  memset(old, 0, sizeof(*old));
+  old->pi = pi;
+  return old;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Add the AFs decoded by rds to the table of its program, which is then the program followed on freq
+// Only AFs decoded since the last call are compared with the table.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_AF::update(int freq, Si4703_RDS &rds)
+{
+  uint16_t pi = rds.getPI();
+  if (pi == 0) return;
+
+  uint8_t n = rds.getAFCount();
+  if (pi != _pi || freq != _freq || n < _merged) _merged = 0;   // Another program, channel or a new list
+  _pi   = pi;
+  _freq = freq;
+
+  afTable_t *t = table(pi, true);
+  t->used = millis();
+  for (; _merged < n; _merged++)
+    {
+      uint8_t code = (rds.getAF(_merged) - 8750) / 10;
+      uint8_t i    = 0;
+      while (i < t->count && t->code[i] != code) i++;
+      if (i < t->count || t->count >= Si4703_RDS::AF_MAX) continue;   // Known or full
+      t->code[t->count] = code;
+      t->rssi[t->count] = RSSI_UNKNOWN;
+      t->count++;
+    }
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Index of the AF with the highest last RSSI (untried ones first) that isn't freq or tried this round
+// Returns -1 if none is left
+//-----------------------------------------------------------------------------------------------------------------------------------
+int8_t Si4703_AF::best(afTable_t *t, int freq, uint32_t tried)
+{
+  int8_t best = -1;
+  for (uint8_t i = 0; i < t->count; i++)
+    {
+      if (tried & (1UL << i)) continue;
+      if (8750 + t->code[i] * 10 == freq) continue; // The channel itself
+      if (best < 0 || t->rssi[i] > t->rssi[best]) best = i;
+    }
+  return best;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Record a check: RSSI of AF i and time off channel
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_AF::checked(afTable_t *t, uint8_t i, uint8_t rssi, unsigned long offTime)
+{
+  t->rssi[i] = (rssi == RSSI_UNKNOWN) ? RSSI_UNKNOWN - 1 : rssi;
+  _checks++;
+  _lastOff  = offTime;
+  _offTime += offTime;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Getters
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint16_t Si4703_AF::getPI(void)
+{
+  return _pi;
+}
+
+uint8_t Si4703_AF::getAFCount(uint16_t pi)
+{
+  afTable_t *t = table(pi, false);
+  return t ? t->count : 0;
+}
+
+int Si4703_AF::getAF(uint16_t pi, uint8_t i)
+{
+  afTable_t *t = table(pi, false);
+  if (!t || i >= t->count) return 0;
+  return 8750 + t->code[i] * 10;
+}
+
+unsigned long Si4703_AF::getOffTime(void)
+{
+  return _offTime;
+}
+
+unsigned long Si4703_AF::getLastOffTime(void)
+{
+  return _lastOff;
+}
+
+unsigned long Si4703_AF::getChecks(void)
+{
+  return _checks;
+}
+
+unsigned long Si4703_AF::getSwitches(void)
+{
+  return _switches;
+}
@@ -0,0 +1,150 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  RDS Alternative Frequency following for Si4703: AF tables per program and switching when the signal fades
+ */
+
+#ifndef Si4703_AF_h
+#define Si4703_AF_h
+
+#include "Arduino.h"
+#include "Si4703_RDS.h"
+#include "Si4703_Monitor.h"
+
+//------------------------------------------------------------------------------------------------------------
+
+// Programs with an AF table
+#ifndef SI4703_AF_PROGRAMS
+#define SI4703_AF_PROGRAMS		2
+#endif
+
+//------------------------------------------------------------------------------------------------------------
+// Call poll(radio, monitor) from loop() after monitor.poll(radio) and radio.readRDS(). It collects the AF list
+// decoded by radio.rds into a table per PI. When AF following is enabled and the average RSSI of the monitor
+// stays below the threshold, it checks the best AFs of the program with radio.checkAF(): each check mutes the
+// audio, tunes the AF and waits at most the window for its PI, then stays on it (same PI and at least margin
+// stronger) or returns. AFs are tried by their last measured RSSI, untried first, and at most a few per round.
+//------------------------------------------------------------------------------------------------------------
+class Si4703_AF
+{
+//------------------------------------------------------------------------------------------------------------
+  public:
+	Si4703_AF();
+
+	void		enable(bool en);				// 1=Follow AFs (default off), tables are kept either way
+	bool		isEnabled(void);
+	void		setThreshold(uint8_t rssi);		// Check AFs while the average RSSI is below (default 20)
+	void		setMargin(uint8_t rssi);		// AF must be this much above the average RSSI (default 6)
+	void		setWindow(unsigned int ms);		// Max PI wait per check (default 200ms)
+	void		setHoldOff(unsigned int ms);	// Min time between check rounds (default 10000ms)
+	void		setMaxChecks(uint8_t n);		// Max AFs checked per round (default 2)
+
+	template <class Radio>
+	bool		poll(Radio &radio,				// Collect AFs and follow them, returns true if it switched
+					 Si4703_Monitor &monitor);
+	void		update(int freq,				// Add the AFs decoded by rds for the program on freq
+					   Si4703_RDS &rds);
+	void		clear(void);					// Forget all tables
+
+	uint16_t	getPI(void);					// Get PI of the program followed, 0 if none
+	uint8_t		getAFCount(uint16_t pi);		// Get number of AFs of program pi
+	int			getAF(uint16_t pi, uint8_t i);	// Get AF i of program pi, 0 if none
+
+	unsigned long getOffTime(void);				// Get total ms off channel for AF checks
+	unsigned long getLastOffTime(void);			// Get ms off channel of the last check
+	unsigned long getChecks(void);				// Get number of AFs checked
+	unsigned long getSwitches(void);			// Get number of switches to an AF
+
+	static const uint8_t	RSSI_UNKNOWN	= 0xFF;	// AF not checked yet
+
+//------------------------------------------------------------------------------------------------------------
+  private:
+	struct afTable_t
+	{
+		uint16_t	pi;							// Program, 0 = free
+		uint8_t		count;						// Number of AFs
+		uint8_t		code[Si4703_RDS::AF_MAX];	// AF codes 1-204
+		uint8_t		rssi[Si4703_RDS::AF_MAX];	// RSSI when last checked, RSSI_UNKNOWN if never
+		unsigned long used;						// Last use (ms), the oldest table is replaced
+	};
+
+	// Settings
+	bool		_enabled;
+	uint8_t		_threshold;						// Average RSSI to start checks
+	uint8_t		_margin;						// Required RSSI gain
+	unsigned int	_window;					// PI wait per check (ms)
+	unsigned int	_holdOff;					// Time between rounds (ms)
+	uint8_t		_maxChecks;						// AFs per round
+
+	// State
+	afTable_t	_table[SI4703_AF_PROGRAMS];		// AF tables
+	uint16_t	_pi;							// Program followed
+	int			_freq;							// Channel the program was last seen on
+	uint8_t		_merged;						// AFs of radio.rds already in the table
+	unsigned long	_lastRound;					// Start of last round (ms)
+	bool		_rounds;						// A round happened
+
+	// Statistics
+	unsigned long	_offTime;					// Total time off channel (ms)
+	unsigned long	_lastOff;					// Time off channel of the last check (ms)
+	unsigned long	_checks;					// AFs checked
+	unsigned long	_switches;					// Switches to an AF
+
+	afTable_t*	table(uint16_t pi, bool add);	// Table of pi, new (oldest replaced) if add
+	int8_t		best(afTable_t *t,				// Index of the best AF not tried this round, -1 if none
+					 int freq,
+					 uint32_t tried);
+	void		checked(afTable_t *t,			// Record the result of a check
+						uint8_t i,
+						uint8_t rssi,
+						unsigned long offTime);
+};
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Collect the AFs of the tuned program and, if enabled and the signal is weak, check them
+// One round checks up to setMaxChecks() AFs, a round starts at most every setHoldOff() ms.
+// Returns true if the radio switched to an AF
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Radio> bool Si4703_AF::poll(Radio &radio, Si4703_Monitor &monitor)
+{
+  if (monitor.getSamples() == 0) return false;      // Nothing known about the channel yet
+  int freq = monitor.getLast().freq;
+
+  if (radio.rds.getPI())                            // Program known: collect its AFs
+    update(freq, radio.rds);
+  else if (freq != _freq)                           // Another channel without RDS (yet)
+    _pi = 0;
+
+  if (!_enabled || !_pi) return false;
+  if (monitor.getSamples() < 4) return false;       // Let the average settle on a new channel
+  if (monitor.getRSSI() >= _threshold) return false;
+  if (_rounds && millis() - _lastRound < _holdOff) return false;
+
+  afTable_t *t = table(_pi, false);
+  if (!t || !t->count) return false;
+
+  _rounds    = true;
+  _lastRound = millis();
+  uint8_t  need  = monitor.getRSSI() + _margin;
+  uint32_t tried = 0;
+  for (uint8_t n = 0; n < _maxChecks; n++)
+    {
+      int8_t i = best(t, freq, tried);
+      if (i < 0) break;                             // No more AFs
+      tried |= (1UL << i);
+
+      uint8_t rssi;
+      int     af = 8750 + t->code[i] * 10;
+      bool    ok = radio.checkAF(af, _pi, need, _window, rssi);
+      checked(t, i, rssi, radio.getAFTime());
+      if (ok)
+        {
+          _switches++;
+          _freq = af;
+          monitor.reset();                          // Start over on the new channel
+          return true;
+        }
+    }
+  return false;
+}
+#endif
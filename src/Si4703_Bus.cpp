@@ -0,0 +1,208 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Bus transports for Si4703T<Bus>: Wire, another TwoWire instance, and the 3-wire interface (SEN, SCLK, SDIO)
+ */
+
+#include "Arduino.h"
+#include "Si4703_Bus.h"
+
+static const int  		I2C_ADDR		= 0x10; // I2C address of Si4703 - note that the Wire function assumes non-left-shifted I2C address, not 0b.0010.000W
+static const unsigned long	I2C_TIMEOUT_US	= 25000;	// Wire timeout of a stuck bus, where Wire supports it (AVR)
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Reset the Si4703 with the bus mode selected by SDIO: low = 2-wire, high = 3-wire (SEN high in both)
+//-----------------------------------------------------------------------------------------------------------------------------------
+static void	busReset(int rstPin, int sdioPin, int sdioLevel)
+{
+  // Set IO pins directions
+  pinMode(rstPin , OUTPUT);     // Reset pin
+  pinMode(sdioPin, OUTPUT);     // Data IO pin
+
+  // Set communcation mode
+  digitalWrite(rstPin ,LOW);    // Put Si4703 into reset
+  digitalWrite(sdioPin,sdioLevel);  // SDIO level selects the interface
+  delay(1);                     // Delay to allow pins to settle
+  digitalWrite(rstPin ,HIGH);   // Bring Si4703 out of reset with SDIO set and SEN pulled high
+  delay(1);                     // Allow Si4703 to come out of reset
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Begin an I2C peripheral
+//-----------------------------------------------------------------------------------------------------------------------------------
+static void	wireBegin(TwoWire &wire)
+{
+  wire.begin();
+#ifdef WIRE_HAS_TIMEOUT
+  wire.setWireTimeout(I2C_TIMEOUT_US, true);  // Don't hang on a stuck bus (AVR core 1.8.2+)
+#endif
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Read words registers from 0x0A on over I2C, w is only written if all were received
+//-----------------------------------------------------------------------------------------------------------------------------------
+static bool	wireRead(TwoWire &wire, uint16_t *w, uint8_t words)
+{
+  uint8_t n = wire.requestFrom(I2C_ADDR, words * 2);
+  if (n < words * 2)                        // NACK or short read
+    {
+      while (wire.available()) wire.read();
+      return false;
+    }
+  for(int i = 0 ; i<words; i++) {
+    w[i] = (wire.read()<<8) | wire.read();
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Write words registers from 0x02 on over I2C
+//-----------------------------------------------------------------------------------------------------------------------------------
+static bool	wireWrite(TwoWire &wire, const uint16_t *w, uint8_t words)
+{
+  wire.beginTransmission(I2C_ADDR);
+  for(int i = 0 ; i<words; i++) {
+    wire.write(w[i] >> 8);                  // Upper byte
+    wire.write(w[i] & 0x00FF);              // Lower byte
+  }
+  return (wire.endTransmission() == 0);     // End this transmission
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_Wire
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_Wire::Si4703_Wire(int sdioPin)
+{
+  _sdioPin = sdioPin;
+}
+
+void	Si4703_Wire::select(int rstPin)
+{
+  busReset(rstPin, _sdioPin, LOW);          // A low SDIO indicates a 2-wire interface
+  wireBegin(Wire);                          // Now that the unit is reset and I2C inteface mode, we need to begin I2C
+}
+
+void	Si4703_Wire::begin(void)
+{
+  wireBegin(Wire);
+}
+
+bool	Si4703_Wire::read(uint16_t *w, uint8_t words)
+{
+  return wireRead(Wire, w, words);
+}
+
+bool	Si4703_Wire::write(const uint16_t *w, uint8_t words)
+{
+  return wireWrite(Wire, w, words);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_TwoWire
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_TwoWire::Si4703_TwoWire(TwoWire &wire, int sdioPin) : _wire(wire)
+{
+  _sdioPin = sdioPin;
+}
+
+void	Si4703_TwoWire::select(int rstPin)
+{
+  busReset(rstPin, _sdioPin, LOW);          // A low SDIO indicates a 2-wire interface
+  wireBegin(_wire);
+}
+
+void	Si4703_TwoWire::begin(void)
+{
+  wireBegin(_wire);
+}
+
+bool	Si4703_TwoWire::read(uint16_t *w, uint8_t words)
+{
+  return wireRead(_wire, w, words);
+}
+
+bool	Si4703_TwoWire::write(const uint16_t *w, uint8_t words)
+{
+  return wireWrite(_wire, w, words);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_3Wire
+// SCLK runs at most at 500kHz (1us half period), well below the 2.5MHz maximum, also on fast MCUs.
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_3Wire::Si4703_3Wire(int senPin, int sdioPin, int sclkPin)
+{
+  _senPin  = senPin;
+  _sdioPin = sdioPin;
+  _sclkPin = sclkPin;
+}
+
+void	Si4703_3Wire::select(int rstPin)
+{
+  begin();                                  // SEN high, SCLK low
+  busReset(rstPin, _sdioPin, HIGH);         // A high SDIO indicates a 3-wire interface
+}
+
+void	Si4703_3Wire::begin(void)
+{
+  pinMode(_senPin , OUTPUT);
+  pinMode(_sclkPin, OUTPUT);
+  pinMode(_sdioPin, OUTPUT);
+  digitalWrite(_senPin , HIGH);             // No transfer
+  digitalWrite(_sclkPin, LOW);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Start a transfer: SEN low, then A7:A5 = 011, R/W, A4:A0 MSB first
+// On a read SDIO is released after the last control bit, the Si4703 drives it from the next falling edge.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void	Si4703_3Wire::control(uint8_t reg, bool rd)
+{
+  uint16_t cmd = (0x3 << 6) | (rd << 5) | (reg & 0x1F);
+
+  digitalWrite(_senPin, LOW);               // Start of transfer
+  for (int8_t b = 8; b >= 0; b--)
+    {
+      digitalWrite(_sdioPin, (cmd >> b) & 1);
+      digitalWrite(_sclkPin, HIGH);         // Latched on the rising edge
+      delayMicroseconds(1);
+      if (b == 0 && rd) pinMode(_sdioPin, INPUT); // Turn SDIO around before the device drives it
+      digitalWrite(_sclkPin, LOW);
+      delayMicroseconds(1);
+    }
+}
+
+bool	Si4703_3Wire::read(uint16_t *w, uint8_t words)
+{
+  for (uint8_t i = 0; i < words; i++)
+    {
+      control((0x0A + i) & 0x0F, true);     // i=0-15 >> Reg=0x0A-0x0F,0x00-0x09
+      uint16_t v = 0;
+      for (uint8_t b = 0; b < 16; b++)
+        {
+          digitalWrite(_sclkPin, HIGH);
+          delayMicroseconds(1);
+          v = (v << 1) | (digitalRead(_sdioPin) ? 1 : 0);
+          digitalWrite(_sclkPin, LOW);
+          delayMicroseconds(1);
+        }
+      digitalWrite(_senPin, HIGH);          // End of transfer
+      pinMode(_sdioPin, OUTPUT);
+      w[i] = v;
+    }
+  return true;
+}
+
+bool	Si4703_3Wire::write(const uint16_t *w, uint8_t words)
+{
+  for (uint8_t i = 0; i < words; i++)
+    {
+      control(0x02 + i, false);             // i=0-7 >> Reg=0x02-0x09
+      for (int8_t b = 15; b >= 0; b--)
+        {
+          digitalWrite(_sdioPin, (w[i] >> b) & 1);
+          digitalWrite(_sclkPin, HIGH);     // Latched on the rising edge
+          delayMicroseconds(1);
+          digitalWrite(_sclkPin, LOW);
+          delayMicroseconds(1);
+        }
+      digitalWrite(_senPin, HIGH);          // End of transfer, register is written
+    }
+  return true;
+}
@@ -0,0 +1,86 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Bus transports for Si4703T<Bus>: Wire, another TwoWire instance, and the 3-wire interface (SEN, SCLK, SDIO)
+ */
+
+#ifndef Si4703_Bus_h
+#define Si4703_Bus_h
+
+#include "Arduino.h"
+#include "Wire.h"
+
+//------------------------------------------------------------------------------------------------------------
+// A transport is any class with these members, called directly by Si4703T<Bus> (no virtual functions):
+//   void select(int rstPin);                          Reset the Si4703 into this bus mode and start the bus
+//   void begin(void);                                 Start the bus without a reset (warmStart())
+//   bool read(uint16_t *w, uint8_t words);            Read words registers from 0x0A on (wrapping), one attempt
+//   bool write(const uint16_t *w, uint8_t words);     Write words registers from 0x02 on, one attempt
+// read()/write() return false on a bus error, the driver retries. read() may be called from the GPIO2 ISR
+// with interrupts enabled again.
+//------------------------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------------------------
+// 2-wire (I2C) on the Arduino Wire object
+//------------------------------------------------------------------------------------------------------------
+class Si4703_Wire
+{
+  public:
+	explicit Si4703_Wire(int sdioPin = A4);	// SDIO (SDA) pin, held low at reset to select 2-wire mode
+
+	void	select(int rstPin);				// Reset into 2-wire mode and begin Wire
+	void	begin(void);					// Begin Wire
+	bool	read(uint16_t *w, uint8_t words);		// Read registers 0x0A.. (2 bytes each)
+	bool	write(const uint16_t *w, uint8_t words);	// Write registers 0x02..
+
+  private:
+	int		_sdioPin;						// SDIO (SDA) pin
+};
+
+//------------------------------------------------------------------------------------------------------------
+// 2-wire (I2C) on another TwoWire instance, e.g. Wire1 on boards with several I2C peripherals
+//------------------------------------------------------------------------------------------------------------
+class Si4703_TwoWire
+{
+  public:
+	explicit Si4703_TwoWire(TwoWire &wire,	// I2C peripheral
+							int sdioPin);	// Its SDIO (SDA) pin, held low at reset to select 2-wire mode
+
+	void	select(int rstPin);				// Reset into 2-wire mode and begin the I2C peripheral
+	void	begin(void);					// Begin the I2C peripheral
+	bool	read(uint16_t *w, uint8_t words);		// Read registers 0x0A.. (2 bytes each)
+	bool	write(const uint16_t *w, uint8_t words);	// Write registers 0x02..
+
+  private:
+	TwoWire	&_wire;							// I2C peripheral
+	int		_sdioPin;						// SDIO (SDA) pin
+};
+
+//------------------------------------------------------------------------------------------------------------
+// 3-wire interface, bit-banged on any three pins (datasheet "3-Wire Control Interface")
+// Each register is one 25 bit transfer framed by SEN low: control word A7:A5 = 011, R/W, A4:A0, then 16 data
+// bits MSB first. Data is latched on the rising edge of SCLK, on reads the Si4703 drives SDIO after each
+// falling edge. SEN must be wired to the MCU (the breakout board only pulls it high).
+// There is no acknowledge, so read()/write() always succeed, a missing device is found by the DEVICEID check.
+//------------------------------------------------------------------------------------------------------------
+class Si4703_3Wire
+{
+  public:
+	Si4703_3Wire(int senPin,				// Serial Enable Pin
+				 int sdioPin,				// Serial Data IO Pin, high at reset to select 3-wire mode
+				 int sclkPin);				// Serial Clock Pin
+
+	void	select(int rstPin);				// Reset into 3-wire mode
+	void	begin(void);					// Set the idle pin levels
+	bool	read(uint16_t *w, uint8_t words);		// Read registers 0x0A.. (one transfer each)
+	bool	write(const uint16_t *w, uint8_t words);	// Write registers 0x02.. (one transfer each)
+
+  private:
+	void	control(uint8_t reg, bool rd);	// SEN low and clock out the 9 bit control word
+
+	int		_senPin;						// Serial Enable Pin
+	int		_sdioPin;						// Serial Data IO Pin
+	int		_sclkPin;						// Serial Clock Pin
+};
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Signal quality monitor for Si4703
+ *  Averages are 8.8 fixed point with a shift per sample, no division or floating point.
+ */
+
+#include "Arduino.h"
+#include "Si4703_Monitor.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_Monitor Class Initialization
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_Monitor::Si4703_Monitor()
+{
+  _interval = 100;        // 10 samples per second
+  _shift    = 3;          // New sample weighs 1/8
+  _window   = 10;         // 1s windows
+  _lostTh   = 15;
+  _okTh     = 20;
+  _debounce = 3;
+  _cb       = NULL;
+  reset();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Forget all samples and states, the next sample starts over
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Monitor::reset(void)
+{
+  _time     = 0;
+  _samples  = 0;
+  memset(&_last, 0, sizeof(_last));
+  _rssiAvg  = 0;
+  _stAvg    = 0;
+  _min      = 255;
+  _max      = 0;
+  _winMin   = 0;
+  _winMax   = 0;
+  _winCount = 0;
+  _winDone  = false;
+  _signal   = false;
+  _stereo   = false;
+  _rds      = false;
+  _stRun    = 0;
+  _rdsRun   = 0;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Settings
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Monitor::setInterval(unsigned int ms)
+{
+  _interval = ms;
+}
+
+void Si4703_Monitor::setSmoothing(uint8_t shift)
+{
+  if (shift > 7) shift = 7;                 // Keeps (sample << 8) - average in range
+  _shift = shift;
+}
+
+void Si4703_Monitor::setWindow(uint8_t samples)
+{
+  if (samples < 1) samples = 1;
+  _window = samples;
+}
+
+void Si4703_Monitor::setSignalThresholds(uint8_t lost, uint8_t ok)
+{
+  if (ok < lost) ok = lost;                 // No negative hysteresis
+  _lostTh = lost;
+  _okTh   = ok;
+}
+
+void Si4703_Monitor::setDebounce(uint8_t samples)
+{
+  if (samples < 1) samples = 1;
+  _debounce = samples;
+}
+
+void Si4703_Monitor::onEvent(eventCallback_t cb)
+{
+  _cb = cb;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Call the callback with the last sample
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Monitor::event(uint8_t ev)
+{
+  if (_cb) _cb(ev, _last);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Change state after _debounce samples in a row disagree with it
+// Returns true if state changed
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_Monitor::debounce(bool now, bool &state, uint8_t &run)
+{
+  if (now == state)
+    {
+      run = 0;
+      return false;
+    }
+  if (++run < _debounce) return false;
+  state = now;
+  run   = 0;
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Add a sample: update averages, window min/max and states, and report state changes
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Monitor::update(const signal_t &s)
+{
+  if (_samples && s.freq != _last.freq)             // New channel
+    {
+      unsigned long t = _time;
+      reset();
+      _time = t;                                    // Keep the sample time from poll()
+    }
+  _last = s;
+
+  uint16_t rssi = (uint16_t)s.rssi << 8;
+  uint16_t st   = s.st ? (100 << 8) : 0;
+
+  if (_samples == 0)                                // First sample: states without events
+    {
+      _rssiAvg = rssi;
+      _stAvg   = st;
+      _signal  = (s.rssi >= _okTh);
+      _stereo  = s.st;
+      _rds     = s.rdss;
+    }
+  else
+    {
+      _rssiAvg += ((int32_t)rssi - _rssiAvg) >> _shift;
+      _stAvg   += ((int32_t)st   - _stAvg)   >> _shift;
+    }
+  _samples++;
+
+  if (s.rssi < _min) _min = s.rssi;                 // Window min/max
+  if (s.rssi > _max) _max = s.rssi;
+  if (++_winCount >= _window)
+    {
+      _winMin   = _min;
+      _winMax   = _max;
+      _winDone  = true;
+      _min      = 255;
+      _max      = 0;
+      _winCount = 0;
+    }
+
+  uint8_t avg = (_rssiAvg + 0x80) >> 8;             // Rounded
+  if (_signal && avg < _lostTh)
+    {
+      _signal = false;
+      event(MON_SIGNAL_LOST);
+    }
+  else if (!_signal && avg >= _okTh)
+    {
+      _signal = true;
+      event(MON_SIGNAL_OK);
+    }
+
+  if (debounce(s.st, _stereo, _stRun))  event(_stereo ? MON_STEREO   : MON_STEREO_LOST);
+  if (debounce(s.rdss, _rds, _rdsRun))  event(_rds    ? MON_RDS_SYNC : MON_RDS_LOST);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Getters
+//-----------------------------------------------------------------------------------------------------------------------------------
+const signal_t& Si4703_Monitor::getLast(void)
+{
+  return _last;
+}
+
+uint8_t Si4703_Monitor::getRSSI(void)
+{
+  return (_rssiAvg + 0x80) >> 8;
+}
+
+uint8_t Si4703_Monitor::getStereo(void)
+{
+  return (_stAvg + 0x80) >> 8;
+}
+
+uint8_t Si4703_Monitor::getMinRSSI(void)
+{
+  if (_winDone)  return _winMin;
+  if (_winCount) return _min;
+  return 0;
+}
+
+uint8_t Si4703_Monitor::getMaxRSSI(void)
+{
+  if (_winDone)  return _winMax;
+  return _max;
+}
+
+bool Si4703_Monitor::hasSignal(void)
+{
+  return _signal;
+}
+
+bool Si4703_Monitor::isStereo(void)
+{
+  return _stereo;
+}
+
+bool Si4703_Monitor::isRDSSync(void)
+{
+  return _rds;
+}
+
+unsigned long Si4703_Monitor::getSamples(void)
+{
+  return _samples;
+}
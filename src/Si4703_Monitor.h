@@ -0,0 +1,119 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Signal quality monitor for Si4703: smoothed RSSI, window min/max and hysteresis events
+ */
+
+#ifndef Si4703_Monitor_h
+#define Si4703_Monitor_h
+
+#include "Arduino.h"
+
+//------------------------------------------------------------------------------------------------------------
+
+// Monitor events
+static const uint8_t	MON_SIGNAL_LOST	= 0;	// Average RSSI fell below the lost threshold
+static const uint8_t	MON_SIGNAL_OK	= 1;	// Average RSSI rose to the ok threshold again
+static const uint8_t	MON_STEREO_LOST	= 2;	// Stereo indicator off for the debounce count of samples
+static const uint8_t	MON_STEREO		= 3;	// Stereo indicator on for the debounce count of samples
+static const uint8_t	MON_RDS_LOST	= 4;	// RDS synchronization off for the debounce count of samples
+static const uint8_t	MON_RDS_SYNC	= 5;	// RDS synchronization on for the debounce count of samples
+
+//------------------------------------------------------------------------------------------------------------
+// One status sample: STATUSRSSI and READCHAN (a 4 byte read)
+//------------------------------------------------------------------------------------------------------------
+struct signal_t
+{
+	int			freq;				// Channel (READCHAN)
+	uint8_t		rssi;				// RSSI
+	bool		st;					// Stereo indicator
+	bool		rdss;				// RDS synchronized
+	bool		afcrl;				// AFC rail (off frequency or no signal)
+};
+
+//------------------------------------------------------------------------------------------------------------
+// Call poll(radio) from loop(): every interval it samples the tuned channel with radio.readSignal() (4 bytes)
+// and updates an exponentially weighted average of RSSI and stereo, RSSI min/max per window of samples and the
+// signal, stereo and RDS sync states. State changes are reported to the event callback. The first samples on a
+// channel set the states without events, a new channel starts over. Nothing is sampled while tuning/seeking.
+//------------------------------------------------------------------------------------------------------------
+class Si4703_Monitor
+{
+//------------------------------------------------------------------------------------------------------------
+  public:
+	typedef void (*eventCallback_t)(uint8_t event, const signal_t &s);	// MON_xxx and the sample causing it
+
+	Si4703_Monitor();
+
+	void		setInterval(unsigned int ms);	// Sample period (default 100ms)
+	void		setSmoothing(uint8_t shift);	// Average weight of a new sample 1/2^shift, 0-7 (default 3: 1/8)
+	void		setWindow(uint8_t samples);		// Samples per min/max window (default 10)
+	void		setSignalThresholds(uint8_t lost,	// Average RSSI below lost: MON_SIGNAL_LOST (default 15)
+									uint8_t ok);	// Average RSSI at or above ok: MON_SIGNAL_OK (default 20)
+	void		setDebounce(uint8_t samples);	// Equal samples to change stereo/RDS sync state (default 3)
+	void		onEvent(eventCallback_t cb);	// Event callback, NULL = none
+
+	template <class Radio>
+	bool		poll(Radio &radio);				// Sample if the interval is over, returns true if sampled
+	void		update(const signal_t &s);		// Add a sample
+	void		reset(void);					// Forget all samples and states
+
+	const signal_t&	getLast(void);				// Get last sample
+	uint8_t		getRSSI(void);					// Get average RSSI
+	uint8_t		getStereo(void);				// Get average stereo share 0-100%
+	uint8_t		getMinRSSI(void);				// Get lowest RSSI of the last complete window (else current)
+	uint8_t		getMaxRSSI(void);				// Get highest RSSI of the last complete window (else current)
+	bool		hasSignal(void);				// Signal state (hysteresis on the average RSSI)
+	bool		isStereo(void);					// Stereo state (debounced)
+	bool		isRDSSync(void);				// RDS sync state (debounced)
+	unsigned long getSamples(void);				// Get number of samples on this channel
+
+//------------------------------------------------------------------------------------------------------------
+  private:
+	// Settings
+	unsigned int	_interval;					// Sample period (ms)
+	uint8_t		_shift;							// Average weight 1/2^shift
+	uint8_t		_window;						// Samples per window
+	uint8_t		_lostTh;						// Signal lost threshold
+	uint8_t		_okTh;							// Signal ok threshold
+	uint8_t		_debounce;						// Equal samples to change state
+	eventCallback_t	_cb;						// Event callback
+
+	// Samples
+	unsigned long	_time;						// Last sample time (ms)
+	unsigned long	_samples;					// Samples on this channel
+	signal_t	_last;							// Last sample
+	uint16_t	_rssiAvg;						// Average RSSI (8.8 fixed point)
+	uint16_t	_stAvg;							// Average stereo share (0-100% as 8.8 fixed point)
+	uint8_t		_min, _max;						// Current window min/max
+	uint8_t		_winMin, _winMax;				// Last complete window min/max
+	uint8_t		_winCount;						// Samples in current window
+	bool		_winDone;						// A window completed
+
+	// States
+	bool		_signal;						// Signal ok
+	bool		_stereo;						// Stereo
+	bool		_rds;							// RDS synchronized
+	uint8_t		_stRun;							// Samples disagreeing with _stereo in a row
+	uint8_t		_rdsRun;						// Samples disagreeing with _rds in a row
+
+	void		event(uint8_t ev);				// Call the callback
+	bool		debounce(bool now, bool &state, uint8_t &run);	// Returns true if state changed
+};
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Sample radio if the interval is over and it isn't tuning/seeking. One readSignal() (4 bytes) per sample.
+// Returns true if a sample was taken
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Radio> bool Si4703_Monitor::poll(Radio &radio)
+{
+  if (_samples && millis() - _time < _interval) return false;   // Not yet
+  if (radio.isBusy() || radio.isAsleep()) return false;   // Channel is changing or powered down
+
+  signal_t s;
+  _time = millis();
+  if (radio.readSignal(s)) return false;            // Bus error
+  update(s);
+  return true;
+}
+#endif
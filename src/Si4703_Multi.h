@@ -0,0 +1,256 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Several Si4703 tuners, each on its own bus, driven in parallel: band surveys split across the tuners
+ */
+
+#ifndef Si4703_Multi_h
+#define Si4703_Multi_h
+
+#include "Si4703.h"
+
+//------------------------------------------------------------------------------------------------------------
+// Up to N tuners of type Radio, e.g. Si4703T<Si4703_TwoWire>, each bound to its own transport (one per I2C
+// peripheral, or 3-wire with its own SEN pin). Every Si4703 answers at the same I2C address, so tuners can't
+// share a bus. The tuners are declared by the sketch and started with start() as usual:
+//   Si4703T<Si4703_TwoWire>              tunerA(Si4703_TwoWire(Wire,  SDA),  4);
+//   Si4703T<Si4703_TwoWire>              tunerB(Si4703_TwoWire(Wire1, SDA1), 5);
+//   Si4703_Multi<Si4703T<Si4703_TwoWire>, 2>  tuners;
+//   tuners.add(tunerA);  tuners.add(tunerB);
+//   int n = tuners.scanBand(list, 20);
+// All tuners must use the same region. Tuners of one type share the GPIO2 interrupt: only one of them can use
+// setInterrupt()/setRDSInterrupt() (the others get false and poll STC), which the scan handles either way.
+//------------------------------------------------------------------------------------------------------------
+template <class Radio, uint8_t N>
+class Si4703_Multi
+{
+//------------------------------------------------------------------------------------------------------------
+  public:
+	Si4703_Multi() : _count(0), _scanTime(0) {}
+
+	bool		add(Radio &radio);				// Add a started tuner, returns false if full
+	uint8_t		count(void)				{ return _count; }			// Get number of tuners
+	Radio&		operator[](uint8_t i)	{ return *_radio[i]; }		// Get tuner i, e.g. tuners[1].beginSeek(...)
+
+	bool		poll(void);						// Advance async tune/seek on all tuners. Returns true while any is busy
+
+	int			scanBand(station_t *list,		// Scan the whole band with all tuners into list, sorted by channel
+						 int maxStations,		// list size
+						 uint8_t mode = SCAN_SEEK,	// SCAN_SEEK or SCAN_STEP
+						 unsigned int piWait = 0);	// ms to wait for RDS PI on each station, 0 = skip
+	unsigned long getScanTime(void)		{ return _scanTime; }		// Get duration of last scanBand() in ms
+
+//------------------------------------------------------------------------------------------------------------
+  private:
+	static const uint8_t	SLICE_TUNE	= 0;	// Tuning a channel of the slice
+	static const uint8_t	SLICE_SEEK	= 1;	// Seeking the next station
+	static const uint8_t	SLICE_PI	= 2;	// Listening for the PI of the last station
+	static const uint8_t	SLICE_DONE	= 3;	// Slice finished
+
+	struct slice_t
+	{
+		uint8_t			state;					// SLICE_xxx
+		int				end;					// Top channel of the slice
+		int				ch;						// Channel of the last completed tune/seek
+		int				last;					// Index in list of this slice's last station, -1 if none
+		unsigned long	time;					// Start of PI wait
+		unsigned long	rdsTime;				// Last RDS read
+	};
+
+	void		next(uint8_t i, uint8_t mode, int spacing);	// Start the next tune/seek of slice i
+
+	Radio		*_radio[N];						// Tuners
+	slice_t		_slice[N];						// Survey state per tuner
+	uint8_t		_count;							// Number of tuners
+	unsigned long _scanTime;					// Duration of last scanBand() in ms
+};
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Add a tuner
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Radio, uint8_t N>
+bool Si4703_Multi<Radio, N>::add(Radio &radio)
+{
+  if (_count >= N) return false;                    // Full
+  _radio[_count++] = &radio;
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Poll every tuner once, so tune/seeks started on several tuners (tuners[i].beginSeek()) run at the same time
+// Returns true while any tuner is busy
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Radio, uint8_t N>
+bool Si4703_Multi<Radio, N>::poll(void)
+{
+  bool busy = false;
+  for (uint8_t i = 0; i < _count; i++)
+    if (_radio[i]->poll()) busy = true;
+  return busy;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Start the next tune/seek of slice i, or finish it at the top of the slice
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Radio, uint8_t N>
+void Si4703_Multi<Radio, N>::next(uint8_t i, uint8_t mode, int spacing)
+{
+  slice_t &s = _slice[i];
+  bool     started;
+
+  if (mode == SCAN_SEEK)
+    {
+      started = _radio[i]->beginSeek(Radio::SEEK_UP);
+      s.state = SLICE_SEEK;
+    }
+  else
+    {
+      if (s.ch + spacing > s.end) started = false;  // Top of slice reached
+      else started = _radio[i]->beginTune(s.ch + spacing);
+      s.state = SLICE_TUNE;
+    }
+  if (!started) s.state = SLICE_DONE;               // Top of slice or bus error
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Scan the whole band like Radio::scanBand(), with the band split into one slice of channels per tuner
+// Each tuner starts at the bottom of its slice, then seeks up (SCAN_SEEK) or tunes every channel (SCAN_STEP)
+// until it passes the top of its slice. All tuners run at the same time, so the scan takes about 1/N of the
+// time of one tuner. Stations are found by the same rules as Radio::scanBand(), local peaks of SCAN_STEP
+// are also merged across slice boundaries. Tuners are muted and seek with SKMODE_STOP while scanning, like
+// Radio::scanBand(). Every tuner returns to its channel, audio settings are unchanged.
+// If list fills up the scan stops early, which stations it holds then depends on the order they were found.
+// Returns the number of stations found, sorted by channel, getScanTime() returns the duration
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Radio, uint8_t N>
+int Si4703_Multi<Radio, N>::scanBand(station_t *list, int maxStations, uint8_t mode, unsigned int piWait)
+{
+  unsigned long start = millis();
+  int      count = 0;
+  int      freq[N];                                 // Channel to return to
+  station_t t;
+
+  if (_count == 0) return 0;
+  int bandStart = _radio[0]->getBandStart();
+  int spacing   = _radio[0]->getBandSpace();
+  int channels  = (_radio[0]->getBandEnd() - bandStart) / spacing + 1;
+
+  for (uint8_t i = 0; i < _count; i++)              // Tune every tuner to the bottom of its slice
+    {
+      _radio[i]->cancel();                          // Abort any async tune/seek in progress
+      freq[i] = _radio[i]->getChannel();            // 0 on a bus error: the tuner stays at the end of its slice
+      _radio[i]->setScanning(true);                 // Mute, stop at band end
+      slice_t &s = _slice[i];
+      s.end   = bandStart + ((long)(i + 1) * channels / _count - 1) * spacing;
+      s.ch    = bandStart + ((long)i * channels / _count) * spacing;
+      s.last  = -1;
+      s.state = _radio[i]->beginTune(s.ch) ? SLICE_TUNE : SLICE_DONE;
+    }
+
+  for (;;)
+    {
+      bool active = false;
+      for (uint8_t i = 0; i < _count; i++)
+        {
+          slice_t &s = _slice[i];
+          Radio   &r = *_radio[i];
+
+          if (s.state == SLICE_DONE) continue;
+          active = true;
+
+          if (s.state == SLICE_PI)                  // Listen for PI
+            {
+              if (r.rds.getPI() == 0 && millis() - s.time < piWait)
+                {
+                  if (millis() - s.rdsTime >= 20)   // Groups arrive every ~88ms
+                    {
+                      s.rdsTime = millis();
+                      r.readRDS();                  // Decode one group
+                    }
+                  continue;
+                }
+              list[s.last].pi = r.rds.getPI();
+              next(i, mode, spacing);
+              continue;
+            }
+
+          if (r.poll()) continue;                   // Tune/seek in progress
+
+          bool ok = r.getTuned(t);
+          if (!ok || (s.state == SLICE_SEEK && (t.freq <= s.ch || t.freq > s.end)))
+            {
+              s.state = SLICE_DONE;                 // Band limit, next slice reached, bus error or timeout
+              continue;
+            }
+          s.ch = t.freq;
+
+          bool found = (t.rssi >= r.getSeekThreshold()) ||  // Seek stops are stations, tuned channels need SEEKTH
+                       (s.state == SLICE_SEEK);
+          int  k     = count;                       // Entry to fill
+          if (found && mode == SCAN_STEP && s.last >= 0 &&
+              list[s.last].freq == t.freq - spacing)  // Adjacent to last station: keep the peak only
+            {
+              if (t.rssi > list[s.last].rssi) k = s.last;   // Replace last station
+              else found = false;                   // Keep last station
+            }
+
+          if (found && k == count && count >= maxStations)
+            {
+              for (uint8_t j = 0; j < _count; j++)  // List full: stop every tuner
+                {
+                  _radio[j]->cancel();
+                  _slice[j].state = SLICE_DONE;
+                }
+              break;
+            }
+
+          if (found)
+            {
+              list[k] = t;
+              s.last  = k;
+              if (k == count) count++;
+              if (piWait)
+                {
+                  s.state   = SLICE_PI;
+                  s.time    = millis();
+                  s.rdsTime = s.time - 20;          // Read the first group right away
+                  continue;
+                }
+            }
+          next(i, mode, spacing);
+        }
+      if (!active) break;
+      delay(1);                                     // Tune/seek take tens of ms
+    }
+
+  for (int i = 1; i < count; i++)                   // Sort by channel (insertion sort, few stations)
+    {
+      station_t v = list[i];
+      int       j = i;
+      for (; j > 0 && list[j-1].freq > v.freq; j--) list[j] = list[j-1];
+      list[j] = v;
+    }
+
+  if (mode == SCAN_STEP)                            // Peaks split by a slice boundary: keep the higher one
+    {
+      int n = 0;
+      for (int i = 0; i < count; i++)
+        {
+          if (n > 0 && list[n-1].freq == list[i].freq - spacing)
+            {
+              if (list[i].rssi > list[n-1].rssi) list[n-1] = list[i];
+              continue;
+            }
+          list[n++] = list[i];
+        }
+      count = n;
+    }
+
+  for (uint8_t i = 0; i < _count; i++)              // Return to the original channels, all at once
+    {
+      _radio[i]->setScanning(false);                // Restore mute and seek mode
+      _radio[i]->beginTune(freq[i] ? freq[i] : _slice[i].ch); // Bus error: write them on the last channel
+    }
+  while (poll()) delay(1);
+
+  _scanTime = millis() - start;
+  return count;
+}
+#endif
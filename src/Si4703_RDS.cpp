@@ -0,0 +1,386 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  RDS/RBDS group decoder for Si4703
+ *  Every call to decode() handles exactly one group with no loops over the message buffers,
+ *  so it can run from loop() without jitter. All buffers live in the object (no heap).
+ */
+
+#include "Arduino.h"
+#include "Si4703_RDS.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_RDS Class Initialization
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_RDS::Si4703_RDS()
+{
+  _maxBler  = BLER_1_2;   // Accept blocks with up to 2 corrected errors
+  reset();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Clear all decoded data
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDS::reset(void)
+{
+  _pi       = 0;
+  _pty      = 0;
+  _tp       = false;
+  _ta       = false;
+  _ms       = false;
+  _groupType= 0;
+  _groupB   = false;
+
+  memset(_ps, ' ', PS_LEN);       _ps[PS_LEN]     = '\0';
+  memset(_psNext, ' ', PS_LEN);   _psNext[PS_LEN] = '\0';
+  _psMask   = 0;
+  _psReady  = false;
+
+  memset(_rt, ' ', RT_LEN);       _rt[RT_LEN]     = '\0';
+  _rtMask   = 0;
+  _rtSegs   = 16;                 // Full length until an end of text (0x0D) is received
+  _rtAB     = -1;
+
+  _afCount  = 0;
+  _afBase   = 0;
+
+  _mjd      = -1;
+  _hour     = 0;
+  _minute   = 0;
+  _offset   = 0;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set highest block error level accepted (BLER_NONE, BLER_1_2, BLER_3_5)
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDS::setMaxBLER(uint8_t bler)
+{
+  if (bler > BLER_3_5) bler = BLER_3_5;   // Uncorrectable blocks are never accepted
+  _maxBler = bler;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Block error level is accepted
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::ok(const rdsGroup_t &g, uint8_t blk)
+{
+  return (g.bler[blk] <= _maxBler);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Map RDS character to printable ASCII, control codes become spaces
+//-----------------------------------------------------------------------------------------------------------------------------------
+char Si4703_RDS::rdsChar(uint8_t c)
+{
+  if (c < 0x20 || c > 0x7E) return ' ';
+  return (char)c;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Decode one RDS group
+// Block B is needed to know the group type, so groups with a rejected block B are dropped.
+// Returns true if the group was accepted
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::decode(const rdsGroup_t &g)
+{
+  if (!ok(g, 1)) return false;                    // Block B rejected
+
+  uint16_t b    = g.block[1];
+  _groupType    = b >> 12;                        // Group type code
+  _groupB       = (b >> 11) & 0x01;               // Version A/B
+
+  // Program Identification from block A, and from block C' in version B groups
+  uint16_t pi = 0;
+  if (ok(g, 0))                 pi = g.block[0];
+  else if (_groupB && ok(g, 2)) pi = g.block[2];
+  if (pi != 0 && pi != _pi)
+    {
+      if (_pi != 0) reset();                      // Different station, drop old data
+      _pi = pi;
+      _groupType = b >> 12;                       // Restore after reset
+      _groupB    = (b >> 11) & 0x01;
+    }
+
+  _tp   = (b >> 10) & 0x01;                       // Traffic Program
+  _pty  = (b >> 5)  & 0x1F;                       // Program Type
+
+  switch (_groupType)
+  {
+    case 0:                                       // 0A/0B Basic tuning and switching information
+      decodePS(g);
+      if (!_groupB) decodeAF(g);
+      break;
+
+    case 2:                                       // 2A/2B RadioText
+      decodeRT(g);
+      break;
+
+    case 4:                                       // 4A Clock Time and date
+      if (!_groupB) decodeCT(g);
+      break;
+
+    default:
+      break;
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Groups 0A/0B: TA, MS and 2 characters of the Program Service name
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDS::decodePS(const rdsGroup_t &g)
+{
+  uint16_t b = g.block[1];
+  _ta = (b >> 4) & 0x01;                          // Traffic Announcement
+  _ms = (b >> 3) & 0x01;                          // Music/Speech
+
+  if (!ok(g, 3)) return;                          // Characters are in block D
+
+  uint8_t seg = b & 0x03;                         // Segment address 0-3
+  _psNext[seg * 2]     = rdsChar(g.block[3] >> 8);
+  _psNext[seg * 2 + 1] = rdsChar(g.block[3] & 0xFF);
+  _psMask |= (1 << seg);
+
+  if (_psMask == 0x0F)                            // All segments received, publish
+    {
+      memcpy(_ps, _psNext, PS_LEN);
+      _psMask  = 0;
+      _psReady = true;
+    }
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Group 0A: two Alternative Frequency codes in block C
+//   224-249  Number of AFs follows (N = code - 224), the other code is the first AF (method A) or the
+//            tuned frequency of the transmitter the list belongs to (method B)
+//   250      An LF/MF frequency follows, not used in the FM band
+//   1-204    87.6-107.9 MHz, 205 filler
+// Method B pairs hold the tuned frequency and one AF: ascending order is the same program, descending a
+// regional variant, which is skipped. Method A pairs are two AFs.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDS::decodeAF(const rdsGroup_t &g)
+{
+  if (!ok(g, 2)) return;                          // AFs are in block C
+
+  uint8_t c1 = g.block[2] >> 8;
+  uint8_t c2 = g.block[2] & 0xFF;
+
+  if (c1 >= 224 && c1 <= 249)                     // Start of a list
+    {
+      _afBase = (c2 >= 1 && c2 <= 204) ? c2 : 0;
+      addAF(c2);                                  // Method A: first AF, method B: the tuned frequency
+      return;
+    }
+  if (c1 == 250 || c2 == 250) return;             // LF/MF pair
+
+  if (_afBase && (c1 == _afBase || c2 == _afBase))  // Method B pair
+    {
+      if (c1 > c2) return;                        // Regional variant
+      addAF(c1 == _afBase ? c2 : c1);
+      return;
+    }
+  addAF(c1);                                      // Method A pair
+  addAF(c2);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Add an AF code, fillers and codes already in the list are ignored
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDS::addAF(uint8_t code)
+{
+  if (code < 1 || code > 204) return;             // Not an FM frequency
+  for (uint8_t i = 0; i < _afCount; i++)
+    if (_af[i] == code) return;                   // Known
+  if (_afCount < AF_MAX) _af[_afCount++] = code;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Groups 2A/2B: 4 (2A) or 2 (2B) characters of RadioText
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDS::decodeRT(const rdsGroup_t &g)
+{
+  uint16_t b  = g.block[1];
+  int8_t   ab = (b >> 4) & 0x01;                  // Text A/B flag
+  uint8_t seg = b & 0x0F;                         // Segment address 0-15
+
+  if (!ok(g, 3)) return;                          // Block D is needed by both versions
+  if (!_groupB && !ok(g, 2)) return;              // 2A also needs block C
+
+  if (ab != _rtAB)                                // A/B toggled: new text
+    {
+      memset(_rt, ' ', RT_LEN);
+      _rt[RT_LEN] = '\0';
+      _rtMask = 0;
+      _rtSegs = 16;
+      _rtAB   = ab;
+    }
+
+  char    c[4];
+  uint8_t n;
+  if (!_groupB)                                   // 2A: 4 chars in blocks C and D
+    {
+      c[0] = g.block[2] >> 8;   c[1] = g.block[2] & 0xFF;
+      c[2] = g.block[3] >> 8;   c[3] = g.block[3] & 0xFF;
+      n    = 4;
+    }
+  else                                            // 2B: 2 chars in block D, 32 chars max
+    {
+      c[0] = g.block[3] >> 8;   c[1] = g.block[3] & 0xFF;
+      n    = 2;
+      _rt[32] = '\0';
+    }
+
+  uint8_t pos = seg * n;
+  for (uint8_t i = 0; i < n; i++)
+    {
+      if (c[i] == 0x0D)                           // End of text
+        {
+          _rt[pos + i] = '\0';
+          _rtSegs = seg + 1;
+          break;
+        }
+      _rt[pos + i] = rdsChar(c[i]);
+    }
+  _rtMask |= (1 << seg);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Group 4A: Clock Time and date
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDS::decodeCT(const rdsGroup_t &g)
+{
+  if (!ok(g, 2) || !ok(g, 3)) return;             // Time is spread over blocks B, C and D
+
+  uint16_t b = g.block[1];
+  uint16_t c = g.block[2];
+  uint16_t d = g.block[3];
+
+  uint8_t hour   = ((c & 0x01) << 4) | (d >> 12);
+  uint8_t minute = (d >> 6) & 0x3F;
+  if (hour > 23 || minute > 59) return;           // Not a valid time
+
+  _mjd    = ((long)(b & 0x03) << 15) | (c >> 1);  // Modified Julian Day
+  _hour   = hour;
+  _minute = minute;
+  _offset = d & 0x1F;                             // Half hours
+  if (d & 0x20) _offset = -_offset;               // Sign
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Program Identification code
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint16_t Si4703_RDS::getPI(void)
+{
+  return(_pi);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Program Type
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint8_t Si4703_RDS::getPTY(void)
+{
+  return(_pty);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Traffic Program flag
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::getTP(void)
+{
+  return(_tp);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Traffic Announcement flag
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::getTA(void)
+{
+  return(_ta);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Music/Speech flag
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::getMS(void)
+{
+  return(_ms);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Program Service name complete
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::hasPS(void)
+{
+  return(_psReady);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Program Service name
+//-----------------------------------------------------------------------------------------------------------------------------------
+const char* Si4703_RDS::getPS(void)
+{
+  return(_ps);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// RadioText complete
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::hasRT(void)
+{
+  if (_rtAB < 0) return false;                    // Nothing received
+  uint16_t need = (_rtSegs >= 16) ? 0xFFFF : ((1u << _rtSegs) - 1);
+  return ((_rtMask & need) == need);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get RadioText
+//-----------------------------------------------------------------------------------------------------------------------------------
+const char* Si4703_RDS::getRT(void)
+{
+  return(_rt);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Alternative Frequencies received
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint8_t Si4703_RDS::getAFCount(void)
+{
+  return _afCount;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Alternative Frequency i, 10 kHz units like the channel (code 1 = 87.6 MHz = 8760)
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703_RDS::getAF(uint8_t i)
+{
+  if (i >= _afCount) return 0;
+  return 8750 + _af[i] * 10;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Clock Time received
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::hasCT(void)
+{
+  return(_mjd >= 0);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get CT date, converted from Modified Julian Day (IEC 62106 Annex G) with integer math
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::getDate(int &year, int &month, int &day)
+{
+  if (_mjd < 0) return false;
+
+  long y  = (_mjd * 100 - 1507820) / 36525;           // Y' = int((MJD - 15078.2) / 365.25)
+  long yd = (y * 36525) / 100;                        // int(Y' * 365.25)
+  long m  = ((_mjd - 14956 - yd) * 10000 - 1000) / 306001;  // M' = int((MJD - 14956.1 - int(Y' x 365.25)) / 30.6001)
+  day     = _mjd - 14956 - yd - (m * 306001) / 10000;
+  int k   = (m == 14 || m == 15) ? 1 : 0;
+  year    = 1900 + y + k;
+  month   = m - 1 - k * 12;
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get CT time
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::getTime(int &hour, int &minute, int &offset)
+{
+  if (_mjd < 0) return false;
+
+  hour    = _hour;
+  minute  = _minute;
+  offset  = _offset * 30;                             // Minutes
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get type of last accepted group
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint8_t Si4703_RDS::getGroupType(void)
+{
+  return(_groupType);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get version of last accepted group
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_RDS::getGroupVersion(void)
+{
+  return(_groupB);
+}
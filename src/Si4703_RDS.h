@@ -0,0 +1,115 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  RDS/RBDS group decoder for Si4703
+ */
+
+#ifndef Si4703_RDS_h
+#define Si4703_RDS_h
+
+#include "Arduino.h"
+
+//------------------------------------------------------------------------------------------------------------
+
+// RDS Block Error Levels (BLERA-BLERD, verbose mode)
+static const uint8_t	BLER_NONE		= 0;	// 0 errors requiring correction
+static const uint8_t	BLER_1_2		= 1;	// 1-2 errors requiring correction
+static const uint8_t	BLER_3_5		= 2;	// 3-5 errors requiring correction
+static const uint8_t	BLER_FAIL		= 3;	// 6+ errors or error in checkword, correction not possible
+
+//------------------------------------------------------------------------------------------------------------
+// One received RDS group: blocks A-D (RDSA-RDSD) and their error levels (BLERA-BLERD)
+//------------------------------------------------------------------------------------------------------------
+struct rdsGroup_t
+{
+	uint16_t	block[4];			// Blocks A, B, C, D
+	uint8_t		bler[4];			// Block error levels A, B, C, D
+};
+
+//------------------------------------------------------------------------------------------------------------
+
+class Si4703_RDS
+{
+//------------------------------------------------------------------------------------------------------------
+  public:
+	Si4703_RDS();
+
+	void		reset(void);				// Clear all decoded data, call after tune/seek
+	bool		decode(const rdsGroup_t &g);// Decode one group, returns true if accepted
+	void		setMaxBLER(uint8_t bler);	// Highest block error level accepted (default BLER_1_2)
+
+	uint16_t	getPI(void);			// Get Program Identification code (0 = not received)
+	uint8_t		getPTY(void);			// Get Program Type 0-31
+	bool		getTP(void);			// Get Traffic Program flag
+	bool		getTA(void);			// Get Traffic Announcement flag
+	bool		getMS(void);			// Get Music/Speech flag (1 = Music)
+
+	bool		hasPS(void);			// True once all 4 PS segments were received
+	const char*	getPS(void);			// Get Program Service name, 8 chars null terminated
+	bool		hasRT(void);			// True once all RadioText segments up to the end were received
+	const char*	getRT(void);			// Get RadioText, up to 64 chars null terminated
+
+	uint8_t		getAFCount(void);		// Get number of Alternative Frequencies received
+	int			getAF(uint8_t i);		// Get Alternative Frequency i (e.g. 9440), 0 if none
+
+	bool		hasCT(void);			// True once a Clock Time group was received
+	bool		getDate(int &year,		// Get CT date (UTC)
+						int &month,
+						int &day);
+	bool		getTime(int &hour,		// Get CT time (UTC) and local time offset in minutes
+						int &minute,
+						int &offset);
+
+	uint8_t		getGroupType(void);		// Get type of last accepted group 0-15
+	bool		getGroupVersion(void);	// Get version of last accepted group (0 = A, 1 = B)
+
+	static const uint8_t	PS_LEN	= 8;	// Program Service name length
+	static const uint8_t	RT_LEN	= 64;	// RadioText length (2A), 2B uses 32
+	static const uint8_t	AF_MAX	= 25;	// Alternative Frequencies kept (a method A list has up to 25)
+
+//------------------------------------------------------------------------------------------------------------
+  private:
+	uint8_t		_maxBler;				// Highest block error level accepted
+
+	// Basic tuning and switching information
+	uint16_t	_pi;					// Program Identification
+	uint8_t		_pty;					// Program Type
+	bool		_tp;					// Traffic Program
+	bool		_ta;					// Traffic Announcement
+	bool		_ms;					// Music/Speech
+	uint8_t		_groupType;				// Last accepted group type
+	bool		_groupB;				// Last accepted group version B
+
+	// Program Service name (groups 0A/0B)
+	char		_ps[PS_LEN + 1];		// Last complete PS
+	char		_psNext[PS_LEN + 1];	// PS being received
+	uint8_t		_psMask;				// Segments of _psNext received (bit n = segment n)
+	bool		_psReady;				// _ps holds a complete PS
+
+	// RadioText (groups 2A/2B)
+	char		_rt[RT_LEN + 1];		// RadioText being received
+	uint16_t	_rtMask;				// Segments received (bit n = segment n)
+	uint8_t		_rtSegs;				// Number of segments up to the end of text
+	int8_t		_rtAB;					// Text A/B flag, -1 = none yet
+
+	// Alternative Frequencies (group 0A)
+	uint8_t		_af[AF_MAX];			// AF codes 1-204 (87.6-107.9 MHz)
+	uint8_t		_afCount;				// Number of AF codes
+	uint8_t		_afBase;				// Frequency after the last "number of AFs" code, 0 = none
+
+	// Clock Time (group 4A)
+	long		_mjd;					// Modified Julian Day, -1 = none yet
+	uint8_t		_hour;					// UTC hour
+	uint8_t		_minute;				// UTC minute
+	int8_t		_offset;				// Local time offset (multiples of 30 minutes)
+
+	// Private Functions
+	bool		ok(const rdsGroup_t &g, uint8_t blk);	// Block error level is accepted
+	char		rdsChar(uint8_t c);						// Map RDS character to printable ASCII
+	void		decodePS(const rdsGroup_t &g);			// Groups 0A/0B
+	void		decodeAF(const rdsGroup_t &g);			// Group 0A
+	void		addAF(uint8_t code);					// Add an AF code to the list
+	void		decodeRT(const rdsGroup_t &g);			// Groups 2A/2B
+	void		decodeCT(const rdsGroup_t &g);			// Group 4A
+};
+#endif
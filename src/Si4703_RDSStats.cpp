@@ -0,0 +1,163 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  RDS reception quality statistics per channel for Si4703
+ *  Only counters are updated per group, rates are calculated by the getters.
+ */
+
+#include "Arduino.h"
+#include "Si4703_RDSStats.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_RDSStats Class Initialization
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_RDSStats::Si4703_RDSStats()
+{
+  clear();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Forget all statistics
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDSStats::clear(void)
+{
+  memset(_table, 0, sizeof(_table));
+  memset(_used, 0, sizeof(_used));
+  _cur    = NULL;
+  _since  = 0;
+  _tuneAt = 0;
+  _rdss   = false;
+  _ps     = false;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Entry of freq, NULL if none
+//-----------------------------------------------------------------------------------------------------------------------------------
+rdsStats_t* Si4703_RDSStats::entry(int freq)
+{
+  for (uint8_t i = 0; i < SI4703_RDS_STATS_CHANNELS; i++)
+    if (_table[i].freq == freq) return &_table[i];
+  return NULL;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Add the time since the last update to the channel tuned
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDSStats::account(void)
+{
+  unsigned long now = millis();
+  if (_cur) _cur->time += now - _since;
+  _since = now;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Tuned to freq (tune or seek completed): close the time on the last channel and start on this one
+// A channel without an entry takes a free one or the least recently tuned.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDSStats::tuned(int freq)
+{
+  account();
+  _cur = NULL;
+  if (freq <= 0) return;                            // Tuning (no channel) or tune failed
+
+  rdsStats_t *e = entry(freq);
+  if (!e)
+    {
+      uint8_t old = 0;
+      for (uint8_t i = 0; i < SI4703_RDS_STATS_CHANNELS; i++)
+        {
+          if (_table[i].freq == 0) { old = i; break; }
+          if (_used[i] < _used[old]) old = i;
+        }
+      e = &_table[old];
+      memset(e, 0, sizeof(*e));
+      e->freq = freq;
+    }
+  _used[e - _table] = millis();
+
+  e->tunes++;
+  e->psTime = 0;
+  _cur    = e;
+  _tuneAt = _since;
+  _rdss   = false;                                  // RDS synchronizes again after a tune
+  _ps     = false;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// A group was received on the channel: count its blocks per error level, and the first complete PS
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDSStats::group(const rdsGroup_t &g, bool ps)
+{
+  if (!_cur) return;
+
+  for (uint8_t i = 0; i < 4; i++)
+    _cur->blocks[g.bler[i] & 0x03]++;
+  _cur->groups++;
+
+  if (ps && !_ps)                                   // First complete PS since the tune
+    {
+      unsigned long t = millis() - _tuneAt;
+      _cur->psTime = (t > 0xFFFF) ? 0xFFFF : t;
+      _cur->psFound++;
+      _ps = true;
+    }
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// RDSS read on the channel: count sync losses
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_RDSStats::sync(bool rdss)
+{
+  if (!_cur) return;
+  if (_rdss && !rdss) _cur->syncLoss++;
+  _rdss = rdss;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Getters
+//-----------------------------------------------------------------------------------------------------------------------------------
+const rdsStats_t* Si4703_RDSStats::get(int freq)
+{
+  account();                                        // Time on the channel tuned up to now
+  return entry(freq);
+}
+
+uint8_t Si4703_RDSStats::getCount(void)
+{
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < SI4703_RDS_STATS_CHANNELS; i++)
+    if (_table[i].freq) n++;
+  return n;
+}
+
+int Si4703_RDSStats::getFreq(uint8_t i)
+{
+  for (uint8_t j = 0; j < SI4703_RDS_STATS_CHANNELS; j++)
+    if (_table[j].freq && i-- == 0) return _table[j].freq;
+  return 0;
+}
+
+uint8_t Si4703_RDSStats::getErrorRate(int freq, uint8_t level)
+{
+  const rdsStats_t *e = get(freq);
+  if (!e || level > BLER_FAIL) return 0;
+
+  uint32_t total = e->blocks[0] + e->blocks[1] + e->blocks[2] + e->blocks[3];
+  uint32_t n     = e->blocks[level];
+  while (total > 0xFFFFFFFFUL / 100)                // Scale down to stay in 32 bits (no 64 bit division on AVR)
+    {
+      total >>= 1;
+      n     >>= 1;
+    }
+  if (!total) return 0;
+  return (uint8_t)((n * 100 + total / 2) / total);
+}
+
+uint16_t Si4703_RDSStats::getGroupRate(int freq)
+{
+  const rdsStats_t *e = get(freq);
+  if (!e) return 0;
+
+  uint32_t groups = e->groups;
+  uint32_t time   = e->time;
+  while (groups > (0xFFFFFFFFUL - time / 2) / 10000) // Scale down to stay in 32 bits
+    {
+      groups >>= 1;
+      time   >>= 1;
+    }
+  if (!time) return 0;
+  return (uint16_t)((groups * 10000 + time / 2) / time);
+}
@@ -0,0 +1,73 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  RDS reception quality statistics per channel for Si4703
+ */
+
+#ifndef Si4703_RDSStats_h
+#define Si4703_RDSStats_h
+
+#include "Arduino.h"
+#include "Si4703_RDS.h"
+
+//------------------------------------------------------------------------------------------------------------
+
+// Channels with statistics (38 bytes RAM each on AVR)
+#ifndef SI4703_RDS_STATS_CHANNELS
+#define SI4703_RDS_STATS_CHANNELS	4
+#endif
+
+//------------------------------------------------------------------------------------------------------------
+// RDS reception statistics of one channel
+//------------------------------------------------------------------------------------------------------------
+struct rdsStats_t
+{
+	int			freq;				// Channel, 0 = free
+	uint32_t	blocks[4];			// Blocks received per error level BLER_NONE ... BLER_FAIL (BLERA-BLERD)
+	uint32_t	groups;				// Groups received
+	uint32_t	time;				// Time tuned to the channel (ms)
+	uint16_t	syncLoss;			// RDSS going off while tuned to the channel
+	uint16_t	tunes;				// Tunes to the channel
+	uint16_t	psFound;			// Tunes that received a complete PS
+	uint16_t	psTime;				// Time from the last tune to its first complete PS (ms), 0 = none
+};
+
+//------------------------------------------------------------------------------------------------------------
+// Attach with radio.setRDSStats(&stats): the driver reports every tune/seek completed, every RDS group read by
+// readRDS() and RDSS from the status reads it does anyway (polled readRDS(), readSignal()), so collecting costs
+// no bus traffic and a few additions per group. Channels are kept in a fixed table, the least recently used one
+// is replaced by a new channel.
+//------------------------------------------------------------------------------------------------------------
+class Si4703_RDSStats
+{
+//------------------------------------------------------------------------------------------------------------
+  public:
+	Si4703_RDSStats();
+
+	void		tuned(int freq);				// Tuned to freq: starts time on channel and time to PS, 0 = tuning
+	void		group(const rdsGroup_t &g,		// Group received on the channel
+					  bool ps);					// A complete PS is known after it
+	void		sync(bool rdss);				// RDSS read on the channel
+	void		clear(void);					// Forget all statistics
+
+	const rdsStats_t* get(int freq);			// Get statistics of freq (time up to now), NULL if none
+	uint8_t		getCount(void);					// Get number of channels with statistics
+	int			getFreq(uint8_t i);				// Get channel of entry i, 0 if none
+	uint8_t		getErrorRate(int freq,			// Get share of blocks at an error level (0-100%)
+							 uint8_t level);	// BLER_NONE ... BLER_FAIL
+	uint16_t	getGroupRate(int freq);			// Get groups per 10 s (114 at most, 11.4 groups/s)
+
+//------------------------------------------------------------------------------------------------------------
+  private:
+	rdsStats_t	_table[SI4703_RDS_STATS_CHANNELS];	// Statistics per channel
+	unsigned long	_used[SI4703_RDS_STATS_CHANNELS];	// Last tune (ms), the oldest entry is replaced
+	rdsStats_t*	_cur;							// Channel tuned, NULL if none
+	unsigned long	_since;						// Time of the tune or of the last time update (ms)
+	unsigned long	_tuneAt;					// Time of the tune (ms)
+	bool		_rdss;							// Last RDSS on the channel
+	bool		_ps;							// Complete PS seen since the tune
+
+	rdsStats_t*	entry(int freq);				// Entry of freq, NULL if none
+	void		account(void);					// Add the time since _since to the channel tuned
+};
+#endif
@@ -0,0 +1,71 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Region (band, spacing, de-emphasis) selected at runtime
+ */
+
+#include "Arduino.h"
+#include "Si4703_Region.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_RuntimeRegion Class Initialization
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_RuntimeRegion::Si4703_RuntimeRegion()
+{
+  _band    = BAND_US_EU;
+  _space   = SPACE_100KHz;
+  _de      = DE_75us;
+  _start   = 8750;
+  _end     = 10800;
+  _spacing = 10;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set FM Band Region limits and spacing
+//-----------------------------------------------------------------------------------------------------------------------------------
+void	Si4703_RuntimeRegion::set(int band,	  // Band Range
+                        int space,	// Band Spacing
+                        int de)		  // De-Emphasis
+{
+  _band  = band;
+  _space = space;
+  _de    = de;
+
+  switch (band)
+  {
+    case BAND_US_EU:      // 87.5–108 MHz (US / Europe, Default)
+      _start = 8750;      // Bottom of Band (kHz)
+      _end		= 10800;	// Top of Band (kHz)
+      break;
+    
+    case BAND_JPW:        // 76–108 MHz (Japan wide band)
+      _start = 7600;      // Bottom of Band (kHz)
+      _end		= 10800;	// Top of Band (kHz)
+      break;
+    
+    case BAND_JP:         // 76–90 MHz (Japan)
+      _start = 7600;	    // Bottom of Band (kHz)
+      _end		= 9000;	  // Top of Band (kHz)
+      break;
+
+    default:
+      break;
+  }
+
+  switch (space)
+  {
+    case SPACE_100KHz:    // 200 kHz (US / Australia, Default)
+      _spacing	= 10;	  // Band Spacing (kHz)
+      break;
+
+    case SPACE_200KHz:    // 100 kHz (Europe / Japan)
+      _spacing	= 20;	  // Band Spacing (kHz)
+      break;
+
+    case SPACE_50KHz:     // 50 kHz (Other)
+      _spacing	= 5;		// Band Spacing (kHz)
+      break;
+    
+    default:
+      break;
+  }
+}
@@ -0,0 +1,124 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Region (band, spacing, de-emphasis) policies for Si4703T<Bus, Region>: set at runtime, or fixed at compile time
+ */
+
+#ifndef Si4703_Region_h
+#define Si4703_Region_h
+
+#include "Arduino.h"
+
+//------------------------------------------------------------------------------------------------------------
+
+// Band Select
+static const uint8_t  	BAND_US_EU		= 0b00;	// 87.5–108 MHz (US / Europe, Default)
+static const uint8_t  	BAND_JPW		= 0b01;	// 76–108 MHz (Japan wide band)
+static const uint8_t  	BAND_JP			= 0b10;	// 76–90 MHz (Japan)
+
+// De-emphasis
+static const uint8_t	DE_75us			= 0b0;	// De-emphasis 75 μs. Used in USA (default)
+static const uint8_t	DE_50us			= 0b1;	// De-emphasis 50 μs. Used in Europe, Australia, Japan.
+
+// Channel Spacing
+static const uint8_t  	SPACE_200KHz	= 0b00;	// 200 kHz (US / Australia, Default)
+static const uint8_t  	SPACE_100KHz 	= 0b01;	// 100 kHz (Europe / Japan)
+static const uint8_t  	SPACE_50KHz  	= 0b10;	//  50 kHz (Other)
+
+//------------------------------------------------------------------------------------------------------------
+// A region policy has these members, frequencies are like 9440 for 94.4 MHz:
+//   void     set(int band, int space, int de);   Select the region (constructor band, space, de)
+//   uint8_t  band(), space(), de();              Register codes
+//   int      start(), end(), spacing();          Band limits and channel spacing
+//   uint16_t chan(int freq);                     Channel (CHAN/READCHAN) of an in-band frequency
+//   int      freq(uint16_t chan);                Frequency of a channel
+//   Freq<FREQ>::value                            FREQ, checked against the band at compile time if possible
+//------------------------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------------------------
+// Region selected at runtime (default): any band and spacing from the constructor
+//------------------------------------------------------------------------------------------------------------
+class Si4703_RuntimeRegion
+{
+  public:
+	Si4703_RuntimeRegion();
+
+	void		set(int band,				// Band Range
+					int space,				// Band Spacing
+					int de);				// De-Emphasis
+
+	uint8_t		band(void)			{ return _band; }
+	uint8_t		space(void)			{ return _space; }
+	uint8_t		de(void)			{ return _de; }
+	int			start(void)			{ return _start; }
+	int			end(void)			{ return _end; }
+	int			spacing(void)		{ return _spacing; }
+	uint16_t	chan(int freq)		{ return (freq - _start) / _spacing; }	// Software division on AVR
+	int			freq(uint16_t chan)	{ return _spacing * chan + _start; }
+
+	template <int FREQ>
+	struct Freq						// No band known at compile time, not checked
+	{
+		static const int	value	= FREQ;
+	};
+
+  private:
+	uint8_t		_band;				// Band Range code
+	uint8_t		_space;				// Band Spacing code
+	uint8_t		_de;				// De-Emphasis
+	int			_start;				// Bottom of Band
+	int			_end;				// Top of Band
+	int			_spacing;			// Band Spacing
+};
+
+//------------------------------------------------------------------------------------------------------------
+// Region fixed at compile time, e.g. Si4703_Region<BAND_US_EU, SPACE_100KHz, DE_75us>
+// Band limits and spacing are constants, so freq() is a multiply by a constant and chan() a multiply by the
+// reciprocal of the spacing and a 16 bit shift (the high word on AVR), exact over the whole band.
+// The constructor band, space and de are ignored.
+//------------------------------------------------------------------------------------------------------------
+template <uint8_t BAND, uint8_t SPACE, uint8_t DE>
+class Si4703_Region
+{
+	static_assert(BAND  <= BAND_JP,     "BAND must be BAND_US_EU, BAND_JPW or BAND_JP");
+	static_assert(SPACE <= SPACE_50KHz, "SPACE must be SPACE_200KHz, SPACE_100KHz or SPACE_50KHz");
+	static_assert(DE    <= DE_50us,     "DE must be DE_75us or DE_50us");
+
+  public:
+	static constexpr int		START		= (BAND == BAND_US_EU) ? 8750 : 7600;	// Bottom of Band
+	static constexpr int		END			= (BAND == BAND_JP)    ? 9000 : 10800;	// Top of Band
+	static constexpr int		SPACING		= (SPACE == SPACE_200KHz) ? 20 :
+											  (SPACE == SPACE_100KHz) ? 10 : 5;		// Band Spacing
+	static constexpr uint16_t	CHANNELS	= (END - START) / SPACING + 1;			// Channels in the band
+
+	void		set(int, int, int)	{}
+
+	static constexpr uint8_t	band(void)			{ return BAND; }
+	static constexpr uint8_t	space(void)			{ return SPACE; }
+	static constexpr uint8_t	de(void)			{ return DE; }
+	static constexpr int		start(void)			{ return START; }
+	static constexpr int		end(void)			{ return END; }
+	static constexpr int		spacing(void)		{ return SPACING; }
+	static uint16_t				chan(int freq)		{ return ((uint32_t)(uint16_t)(freq - START) * RECIP) >> SHIFT; }
+	static constexpr int		freq(uint16_t chan)	{ return START + chan * SPACING; }
+
+	template <int FREQ>
+	struct Freq						// Rejects frequencies outside the band or off the channel grid
+	{
+		static_assert(FREQ >= START && FREQ <= END, "frequency outside the band");
+		static_assert((FREQ - START) % SPACING == 0, "frequency not on the channel grid");
+
+		static const int		value	= FREQ;
+		static const uint16_t	chan	= (FREQ - START) / SPACING;
+	};
+
+  private:
+	static constexpr uint8_t	SHIFT		= 16;
+	static constexpr uint32_t	RECIP		= ((1UL << SHIFT) + SPACING - 1) / SPACING;	// ceil(2^16 / SPACING)
+
+	// floor(x * RECIP / 2^16) == floor(x / SPACING) for all 0 <= x <= END-START if x * (RECIP * SPACING - 2^16) < 2^16
+	static_assert((uint32_t)(END - START) * (RECIP * SPACING - (1UL << SHIFT)) < (1UL << SHIFT),
+				  "reciprocal not exact over the band");
+};
+
+#endif
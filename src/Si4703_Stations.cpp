@@ -0,0 +1,187 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Station table for Si4703: presets, last channel and volume, persisted with a versioned layout and CRC
+ */
+
+#include "Arduino.h"
+#include "Si4703_Region.h"
+#include "Si4703_Stations.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703_Stations Class Initialization
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703_Stations::Si4703_Stations()
+{
+  setRegion(BAND_US_EU, SPACE_100KHz, DE_75us);     // Default region of Si4703
+  clear();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Remove all stations, last channel and volume
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Stations::clear(void)
+{
+  _count  = 0;
+  _last   = 0;
+  _volume = 0;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set region the table belongs to, a saved table of another region is rejected by load()
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Stations::setRegion(uint8_t band, uint8_t space, uint8_t de)
+{
+  _region = (band & 0x03) | ((space & 0x03) << 2) | ((de & 0x01) << 4);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get number of stations
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703_Stations::count(void)
+{
+  return _count;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get maximum number of stations
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703_Stations::capacity(void)
+{
+  return SI4703_STATIONS_MAX;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get stations array
+//-----------------------------------------------------------------------------------------------------------------------------------
+station_t* Si4703_Stations::list(void)
+{
+  return _list;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set number of valid stations in list(), e.g. the result of scanBand()
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Stations::setCount(int n)
+{
+  if (n < 0) n = 0;
+  if (n > SI4703_STATIONS_MAX) n = SI4703_STATIONS_MAX;
+  _count = n;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Add a station
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_Stations::add(int freq, uint8_t rssi, bool st, uint16_t pi)
+{
+  if (_count >= SI4703_STATIONS_MAX) return false;  // Full
+
+  _list[_count].freq = freq;
+  _list[_count].rssi = rssi;
+  _list[_count].st   = st;
+  _list[_count].pi   = pi;
+  _count++;
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get frequency of station i
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703_Stations::getFreq(int i)
+{
+  if (i < 0 || i >= _count) return 0;
+  return _list[i].freq;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set last channel
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Stations::setLast(int freq)
+{
+  _last = freq;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get last channel
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703_Stations::getLast(void)
+{
+  return _last;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set volume
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703_Stations::setVolume(int volume)
+{
+  _volume = volume;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get volume
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703_Stations::getVolume(void)
+{
+  return _volume;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get saved size in bytes including CRC
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703_Stations::size(void)
+{
+  return HEADER_LEN + _count * STATION_LEN + 2;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// CRC-16/CCITT (poly 0x1021) update with one byte, start with 0xFFFF
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint16_t Si4703_Stations::crc16(uint16_t crc, uint8_t b)
+{
+  crc ^= (uint16_t)b << 8;
+  for (uint8_t i = 0; i < 8; i++)
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  return crc;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get saved byte i (excluding CRC)
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint8_t Si4703_Stations::byteAt(int i)
+{
+  switch (i)
+  {
+    case 0: return MAGIC;
+    case 1: return VERSION;
+    case 2: return _region;
+    case 3: return _count;
+    case 4: return _last >> 8;
+    case 5: return _last & 0xFF;
+    case 6: return _volume;
+    default: break;
+  }
+
+  station_t &s = _list[(i - HEADER_LEN) / STATION_LEN];
+  switch ((i - HEADER_LEN) % STATION_LEN)
+  {
+    case 0: return s.freq >> 8;
+    case 1: return s.freq & 0xFF;
+    case 2: return (s.rssi & 0x7F) | (s.st << 7);
+    case 3: return s.pi >> 8;
+    default: return s.pi & 0xFF;
+  }
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set loaded byte i (excluding CRC)
+// Returns false if the header doesn't match this table (magic, version, region, capacity)
+//-----------------------------------------------------------------------------------------------------------------------------------
+bool Si4703_Stations::setByte(int i, uint8_t b)
+{
+  switch (i)
+  {
+    case 0: return (b == MAGIC);
+    case 1: return (b == VERSION);
+    case 2: return (b == _region);
+    case 3: _count  = b;                      return (b <= SI4703_STATIONS_MAX);
+    case 4: _last   = (int)b << 8;            return true;
+    case 5: _last  |= b;                      return true;
+    case 6: _volume = b;                      return true;
+    default: break;
+  }
+
+  station_t &s = _list[(i - HEADER_LEN) / STATION_LEN];
+  switch ((i - HEADER_LEN) % STATION_LEN)
+  {
+    case 0: s.freq  = (int)b << 8;            break;
+    case 1: s.freq |= b;                      break;
+    case 2: s.rssi  = b & 0x7F; s.st = b >> 7; break;
+    case 3: s.pi    = (uint16_t)b << 8;       break;
+    default: s.pi  |= b;                      break;
+  }
+  return true;
+}
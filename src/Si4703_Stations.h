@@ -0,0 +1,142 @@
+/*
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Station table for Si4703: presets, last channel and volume, persisted with a versioned layout and CRC
+ */
+
+#ifndef Si4703_Stations_h
+#define Si4703_Stations_h
+
+#include "Arduino.h"
+
+//------------------------------------------------------------------------------------------------------------
+
+// Station table capacity in stations (5 bytes each when saved)
+#ifndef SI4703_STATIONS_MAX
+#define SI4703_STATIONS_MAX		20
+#endif
+
+//------------------------------------------------------------------------------------------------------------
+// Station found by scanBand() or stored in the station table
+//------------------------------------------------------------------------------------------------------------
+struct station_t
+{
+	int			freq;				// Channel frequency (e.g. 9440 for 94.4 MHz)
+	uint8_t		rssi;				// RSSI when found
+	bool		st;					// Stereo indicator when found
+	uint16_t	pi;					// RDS Program Identification, 0 if not received
+};
+
+//------------------------------------------------------------------------------------------------------------
+// Saved layout (version 1), multi-byte values MSB first:
+//   0      Magic 'S'
+//   1      Version
+//   2      Region: BAND (bits 0-1), SPACE (bits 2-3), DE (bit 4)
+//   3      Station count
+//   4-5    Last channel
+//   6      Volume
+//   7-     count x 5 bytes: freq (2), RSSI (bits 0-6) + ST (bit 7), PI (2)
+//   end    CRC-16/CCITT over all previous bytes (2)
+//------------------------------------------------------------------------------------------------------------
+
+class Si4703_Stations
+{
+//------------------------------------------------------------------------------------------------------------
+  public:
+	Si4703_Stations();
+
+	void		clear(void);					// Remove all stations, last channel and volume
+	void		setRegion(uint8_t band,			// Region the table belongs to (default: Si4703's), call before load()/save()
+						  uint8_t space,
+						  uint8_t de);
+
+	int			count(void);					// Get number of stations
+	int			capacity(void);					// Get maximum number of stations
+	station_t*	list(void);						// Get stations array, e.g. for scanBand(list(), capacity())
+	void		setCount(int n);				// Set number of valid stations in list()
+	bool		add(int freq,					// Add a station, returns false if full
+					uint8_t rssi = 0,
+					bool st = false,
+					uint16_t pi = 0);
+	int			getFreq(int i);					// Get frequency of station i, 0 if none
+
+	void		setLast(int freq);				// Set last channel
+	int			getLast(void);					// Get last channel, 0 if none
+	void		setVolume(int volume);			// Set volume
+	int			getVolume(void);				// Get volume
+
+	int			size(void);						// Get saved size in bytes
+
+	template <class S> int	save(S &storage, int addr = 0);	// Save to storage (e.g. EEPROM), returns bytes
+	template <class S> bool	load(S &storage, int addr = 0);	// Load from storage, false if missing/corrupt/other region
+
+	static const uint8_t	MAGIC		= 'S';	// Layout magic
+	static const uint8_t	VERSION		= 1;	// Layout version
+	static const uint8_t	HEADER_LEN	= 7;	// Bytes before stations
+	static const uint8_t	STATION_LEN	= 5;	// Bytes per station
+
+//------------------------------------------------------------------------------------------------------------
+  private:
+	station_t	_list[SI4703_STATIONS_MAX];		// Stations
+	uint8_t		_count;							// Number of stations
+	uint8_t		_region;						// Packed BAND/SPACE/DE
+	int			_last;							// Last channel
+	uint8_t		_volume;						// Volume
+
+	static uint16_t	crc16(uint16_t crc, uint8_t b);	// CRC-16/CCITT update with one byte
+	uint8_t		byteAt(int i);					// Get saved byte i (excluding CRC)
+	bool		setByte(int i, uint8_t b);		// Set loaded byte i (excluding CRC), false if not valid
+};
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Save the table to storage at addr. storage needs read(int addr) and write(int addr, uint8_t val), like EEPROM.
+// Bytes that didn't change aren't written again to save EEPROM wear.
+// Returns number of bytes used
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class S> int Si4703_Stations::save(S &storage, int addr)
+{
+  int      len = size() - 2;
+  uint16_t crc = 0xFFFF;
+
+  for (int i = 0; i < len + 2; i++)
+    {
+      uint8_t b;
+      if      (i <  len) b = byteAt(i);
+      else if (i == len) b = crc >> 8;              // CRC MSB
+      else               b = crc & 0xFF;            // CRC LSB
+      if (i < len) crc = crc16(crc, b);
+
+      if (storage.read(addr + i) != b) storage.write(addr + i, b);
+    }
+  return len + 2;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Load the table from storage at addr in a single pass
+// Returns false and leaves the table empty if the data is missing, corrupt, another version or another region
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class S> bool Si4703_Stations::load(S &storage, int addr)
+{
+  uint16_t crc = 0xFFFF;
+  int      len = HEADER_LEN;                        // Grows once the station count is known
+
+  for (int i = 0; i < len; i++)
+    {
+      uint8_t b = storage.read(addr + i);
+      crc = crc16(crc, b);
+      if (!setByte(i, b))                           // Bad header
+        {
+          clear();
+          return false;
+        }
+      if (i == 3) len = HEADER_LEN + _count * STATION_LEN;
+    }
+
+  uint16_t saved = (storage.read(addr + len) << 8) | storage.read(addr + len + 1);
+  if (saved != crc)                                 // Corrupt
+    {
+      clear();
+      return false;
+    }
+  return true;
+}
+#endif
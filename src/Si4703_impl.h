@@ -0,0 +1,1925 @@
+/* 
+ *  Muthanna Alwahash 2020/21
+ *
+ *  Si4703T<Bus, Region> implementation, included by Si4703.h (templates are compiled where they are used)
+ */
+
+#ifndef Si4703_impl_h
+#define Si4703_impl_h
+
+template <class Bus, class Region>
+Si4703T<Bus, Region>* Si4703T<Bus, Region>::_isrRadio = NULL;   // Instance served by the GPIO2 interrupt
+
+#if SI4703_STATS
+#define STATS_ADD(field, n)   (_stats.field += (n))             // Count
+#define STATS_BLOCK(api)      StatsBlock statsBlock(*this, api) // Time the rest of the function
+#else
+#define STATS_ADD(field, n)   ((void)(n))
+#define STATS_BLOCK(api)
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703 Class Initialization
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+Si4703T<Bus, Region>::Si4703T( 
+                // Bus
+                const Bus &bus,               // Transport: Si4703_Wire, Si4703_TwoWire, Si4703_3Wire, ...
+
+                // MCU Pins Selection
+                int rstPin,                   // Reset Pin
+			          int intPin,	                  // Seek/Tune Complete and RDS interrupt Pin
+
+                // Band Settings
+			          int band,	                    // Band Range
+                int space,	                  // Band Spacing
+                int de,		                    // De-Emphasis
+
+                // Seek Settings
+			          int skmode,	                  // Seek Mode
+			          int seekth,	                  // Seek Threshold
+			          int skcnt,	                  // Seek Clicks Number Threshold
+			          int sksnr,	                  // Seek Signal/Noise Ratio
+                int agcd	                    // AGC disable
+              ) : _bus(bus)
+{
+  // MCU Pins Selection
+  _rstPin   = rstPin;   // Reset Pin
+  _intPin   = intPin;   // Seek/Tune Complete Pin
+
+  // Band Settings
+  _region.set(band, space, de); // Band Range, Spacing and De-Emphasis (ignored by a fixed region)
+
+  // Seek Settings
+  _skmode   =	skmode;   // Seek Mode Wrap/Stop
+	_seekth   =	seekth;   // Seek Threshold
+	_skcnt    =	skcnt;    // Seek Clicks Number Threshold
+	_sksnr    =	sksnr;	  // Seek Signal/Noise Ratio
+  _agcd     = agcd;     // AGC disable
+
+  // Registers shadow
+  for(int i = 0 ; i<16; i++) shadow.word[i] = 0;  // Empty until primed by getShadow()
+  _dirty    = 0;        // Nothing to write back
+  _busTries = I2C_FAIL_MAX;   // Attempts per bus operation
+  _tuneTimeout = TUNE_TIMEOUT;// Max tune time (ms)
+  _seekTimeout = SEEK_TIMEOUT;// Max seek time (ms)
+  _error    = ERR_NONE; // No error yet
+  _writeBytes = 0;      // Nothing written yet
+  _updateDepth= 0;      // Not in a transaction
+
+  // Idle power down
+  _asleep      = false;
+  _sleepChan   = 0;
+  _idleTimeout = 0;     // Never
+  _lastActive  = 0;
+
+  // Interrupt
+  _stcInt   = false;    // No STC interrupt seen
+
+  // Async Tune/Seek
+  _asyncState = ASYNC_IDLE;
+  _asyncDone  = NULL;
+  _asyncVerify= true;
+  _asyncFreq  = 0;
+  _asyncSFBL  = false;
+  _asyncStart = 0;
+  _asyncUs    = 0;
+  _asyncTook  = 0;
+  _pollAt     = 0;
+  _pollStep   = POLL_MIN_US;
+  _tuneUs     = TUNE_US;
+  _seekChanUs = SEEK_CHAN_US;
+  _seekFrom   = -1;
+  _asyncLimit = 0;
+  _seekProgress = NULL;
+  _seekFreq   = 0;
+
+  // RDS
+  _rdsrLast   = false;
+  _rdsStats   = NULL;
+  _rdsHead    = 0;
+  _rdsTail    = 0;
+  _rdsOverflow= 0;
+  _rdsPending = false;
+  _busLock    = false;
+
+  // Scan
+  _scanTime   = 0;
+  _scanDmute  = 0;
+  _scanSkmode = 0;
+
+  // Alternative Frequencies
+  _afTime     = 0;
+
+  // Oscillator
+  _xosc       = true;   // 32.768kHz crystal
+  _oscDelay   = 500;    // Crystal settle time (ms)
+
+  // Statistics
+#if SI4703_STATS
+  _statsApi   = STATS_API_NONE;
+#endif
+  resetStats();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Si4703 Class Destruction: stop serving the GPIO2 interrupt, so another instance of this type can take it
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+Si4703T<Bus, Region>::~Si4703T()
+{
+  releaseISR();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Read the entire register set (0x00 - 0x0F) to Shadow
+// Reading is in following register address sequence 0A,0B,0C,0D,0E,0F,00,01,02,03,04,05,06,07,08,09 = 16 Words = 32 bytes.
+// The shadow is a cache: this is only needed to prime it after a reset or power up. Any pending
+// (dirty) control register changes in the shadow are overwritten.
+// Returns ERR_NONE or ERR_BUS (shadow unchanged)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte	Si4703T<Bus, Region>::getShadow()
+{
+  uint16_t w[16];
+
+  STATS_ADD(getShadow, 1);
+  byte err = readWords(w, 16);              // Read with retries
+  if (err) return err;
+
+  memcpy(shadow.word, w, sizeof(w));
+  _dirty = 0;                               // Shadow now matches the device
+  return ERR_NONE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Read the first words (1-8) of the volatile status/RDS registers (0x0A - 0x0F) to Shadow
+// Reading always starts at 0x0A, so fetch only as far as the query needs:
+//   1 word  = STATUSRSSI                    =  2 bytes (RSSI, ST, STC, SFBL, ...)
+//   2 words = STATUSRSSI, READCHAN          =  4 bytes (+ current channel)
+//   6 words = STATUSRSSI, READCHAN, RDSA-D  = 12 bytes (+ RDS blocks)
+//   8 words = ... + DEVICEID, CHIPID        = 16 bytes (+ read-only ID, used while powering up)
+// Cached control registers are left untouched.
+// Returns ERR_NONE or ERR_BUS (shadow unchanged)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte	Si4703T<Bus, Region>::readStatus(uint8_t words)
+{
+  uint16_t w[8];
+
+  if (words < 1) words = 1;                 // Accepted words 1-8
+  if (words > 8) words = 8;                 // Accepted words 1-8
+
+  STATS_ADD(readStatus, 1);
+  byte err = readWords(w, words);           // Read with retries
+  if (err) return err;
+
+  memcpy(shadow.word, w, words * 2);        // i=0-7 >> Reg=0x0A-0x0F,0x00-0x01
+  return ERR_NONE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Read words registers from 0x0A on, with up to _busTries attempts
+// w is only written once all words were received, so a failed read can't leave 0xFFFF (STC, SFBL, ...) behind.
+// Worst case: _busTries x transfer time (3ms for 32 bytes at 100kHz I2C, or the Wire timeout on a stuck bus)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte	Si4703T<Bus, Region>::readWords(uint16_t *w, uint8_t words)
+{
+  byte err = ERR_BUS;
+
+  _busLock = true;                          // Keep the RDS ISR off the bus
+  for (byte t = 0; t < _busTries && err; t++)
+    {
+      if (t) STATS_ADD(retries, 1);
+      if (!_bus.read(w, words)) continue;   // NACK or short read, try again
+      STATS_ADD(bytesRead, words * 2);
+      err = ERR_NONE;
+    }
+  busRelease();
+
+  if (err) _error = err;
+  return err;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Write the dirty control registers (0x02 to 0x07) to the Si4703
+// The Si4703 assumes you are writing to 0x02 first, then increments, so the write
+// stops after the highest dirty register: POWERCFG only = 2 bytes ... up to TEST1 = 12 bytes.
+// A failed write is repeated up to _busTries times. If it still fails the registers stay dirty,
+// so the next write takes the changes along.
+// Returns ERR_NONE (also if there is nothing to write) or ERR_BUS
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte 	Si4703T<Bus, Region>::putShadow()
+{
+  _writeBytes = 0;
+  if (!(_dirty & REG_CTRL_MASK)) return ERR_NONE; // Nothing to write
+  if (_asleep) return ERR_NONE;             // Kept dirty, resume() writes the whole state
+
+  uint8_t last = REG_TEST1;                 // Find the highest dirty register
+  while (!(_dirty & (1 << last))) last--;
+  uint8_t words = last - REG_POWERCFG + 1;
+  _writeBytes = words * 2;
+
+  byte err = ERR_BUS;
+  _busLock = true;                          // Keep the RDS ISR off the bus
+  for (byte t = 0; t < _busTries && err; t++)
+    {
+      if (t) STATS_ADD(retries, 1);
+      if (_bus.write(&shadow.word[8], words)) err = ERR_NONE;  // i=8-13 >> Reg=0x02-0x07
+      else STATS_ADD(writeErrors, 1);
+    }
+  STATS_ADD(putShadow, 1);
+  if (err == ERR_NONE)
+    {
+      _dirty = 0;                           // Device now matches the shadow
+      _lastActive = millis();               // Restarts the idle timeout
+      STATS_ADD(bytesWritten, _writeBytes);
+    }
+  else _error = err;
+  busRelease();
+  return err;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Write the dirty control registers from a setter, unless inside beginUpdate()/commit()
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte 	Si4703T<Bus, Region>::updateShadow()
+{
+  if (_updateDepth) return 0;               // Deferred to commit()
+  return putShadow();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Start a configuration transaction
+// Setters (setVolume, setMono, setMute, setVolExt, writeGPIO) only change the shadow until the matching
+// commit(), which writes all changes in one register write. Transactions can be nested.
+// Tune and seek still write immediately, taking pending changes with them.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::beginUpdate(void)
+{
+  _updateDepth++;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// End a configuration transaction, the outermost commit() writes all changed registers at once
+// Returns ERR_NONE (also if there is nothing to write) or ERR_BUS
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte	Si4703T<Bus, Region>::commit(void)
+{
+  if (_updateDepth > 0) _updateDepth--;
+  if (_updateDepth) return 0;               // Still inside an outer transaction
+  return putShadow();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Release the bus after a transaction, and capture an RDS group the ISR had to leave pending
+// With a group pending the bus stays locked for its capture: unlocked, an interrupt in between could
+// capture the same group from the ISR and it would be queued twice.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::busRelease(void)
+{
+  noInterrupts();                                   // Pending is set by the ISR
+  bool pending = _rdsPending;
+  if (!pending) _busLock = false;
+  interrupts();
+  if (pending) captureRDS(false);                   // Unlocks when done
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Read status/RDS registers (0x0A - 0x0F, 12 bytes) and push a ready group to the RDS queue
+// Called from the ISR (isr=1, SI4703_ISR_BUS only) or from the main context when the bus is released or a group
+// is asked for. The shadow is not touched, it may be in use.
+// Wire needs interrupts to run, so they are enabled again while reading from the ISR.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::captureRDS(bool isr)
+{
+  _busLock = true;
+  do
+    {
+      _rdsPending = false;
+      uint16_t w[6];
+      if (isr) interrupts();                        // Let Wire run
+      bool ok = _bus.read(w, 6);                    // i=0-5 >> Reg=0x0A-0x0F
+      if (isr) noInterrupts();
+      STATS_ADD(rdsCaptures, 1);                    // Only updated with the bus locked, never
+      if (ok) STATS_ADD(bytesRead, 12);             // at the same time as the main context
+      if (!ok) continue;                            // Bus error, drop this group (no retries in the ISR)
+
+      STATUSRSSI_t status;  status.word = w[0];
+      READCHAN_t   chan;    chan.word   = w[1];
+      if (status.bits.STC) _stcInt = true;          // Interrupt was (also) STC
+
+      if (status.bits.RDSR)                         // Group ready
+        {
+          if ((uint8_t)(_rdsHead - _rdsTail) >= RDS_QUEUE_LEN)
+            _rdsOverflow++;                         // Queue full, count the lost group
+          else
+            {
+              rdsGroup_t &g = _rdsQueue[_rdsHead & (RDS_QUEUE_LEN - 1)];
+              g.block[0] = w[2];
+              g.block[1] = w[3];
+              g.block[2] = w[4];
+              g.block[3] = w[5];
+              g.bler[0]  = status.bits.BLERA;
+              g.bler[1]  = chan.bits.BLERB;
+              g.bler[2]  = chan.bits.BLERC;
+              g.bler[3]  = chan.bits.BLERD;
+              _rdsHead++;                           // Publish after the group is complete
+            }
+        }
+    }
+  while (_rdsPending);                              // Another interrupt came while reading
+  _busLock = false;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Power Up Device
+// Returns ERR_NONE, ERR_BUS, ERR_DEVICE (not a Si4703) or ERR_TIMEOUT (not up after 110ms)
+// Worst case: oscillator settle time + 110ms + bus retries
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::powerUp()
+{
+  STATS_BLOCK(STATS_POWERUP);
+
+  _asleep = false;                        // Starts from the device state
+
+  // Enable Oscillator
+  if (getShadow()) return ERR_BUS;        // Read the current register set to prime the shadow
+  if (shadow.reg.DEVICEID.word != DEVICEID_SI4703)
+    return (_error = ERR_DEVICE);         // Something else answers at 0x10
+  if (_xosc)                              // Crystal, external clock needs no XOSCEN
+    {
+      shadow.reg.TEST1.bits.XOSCEN = 1;   // Enable the oscillator
+      _dirty |= (1 << REG_TEST1);         // Mark register as changed
+      if (putShadow()) return ERR_BUS;    // Write to registers
+    }
+  delay(_oscDelay);                       // Wait for oscillator to settle
+
+  // Enable Device
+  shadow.reg.POWERCFG.bits.ENABLE   = 1;  // Powerup Enable=1
+  shadow.reg.POWERCFG.bits.DISABLE  = 0;  // Powerup Disable=0
+  shadow.reg.POWERCFG.bits.DMUTE    = 1;  // Disable Mute
+  _dirty |= (1 << REG_POWERCFG);          // Mark register as changed
+  if (putShadow()) return ERR_BUS;        // Write to registers
+
+  return waitPowerUp();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Wait until powered up, max power up time is 110ms. CHIPID DEV/FIRMWARE only become valid once
+// the device is up, so poll them (16 byte read every 5ms) instead of always waiting the maximum.
+// Returns ERR_NONE or ERR_TIMEOUT
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::waitPowerUp(void)
+{
+  unsigned long start = millis();
+  do
+    {
+      delay(5);
+      readStatus(8);                      // Read status and ID registers
+    }
+  while (!isPoweredUp() && (millis() - start < POWERUP_TIMEOUT));
+
+  if (isPoweredUp()) return ERR_NONE;
+  STATS_ADD(timeouts, 1);
+  return (_error = ERR_TIMEOUT);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Powered up: DEV bit 3 and FIRMWARE are only set after power up
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::isPoweredUp(void)
+{
+  return (shadow.reg.CHIPID.bits.DEV & 0x08) || (shadow.reg.CHIPID.bits.FIRMWARE != 0);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Select oscillator
+// xtal = 1: 32.768kHz crystal, XOSCEN is set and settle ms (500 by default) are waited on power up.
+// xtal = 0: external reference clock on RCLK, settle can be 0. Call before start().
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::setOscillator(bool xtal, unsigned int settle)
+{
+  _xosc     = xtal;
+  _oscDelay = settle;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Power Down
+// Returns ERR_NONE or ERR_BUS
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::powerDown()
+{
+  STATS_BLOCK(STATS_POWERDOWN);
+
+  shadow.reg.TEST1.bits.AHIZEN      = 1;      // LOUT/LOUT = High impedance
+
+  shadow.reg.SYSCONFIG1.bits.GPIO1  = GPIO_Z; // GPIO1 = High impedance (default)
+  shadow.reg.SYSCONFIG1.bits.GPIO2  = GPIO_Z; // GPIO2 = High impedance (default)
+  shadow.reg.SYSCONFIG1.bits.GPIO3  = GPIO_Z; // GPIO3 = High impedance (default)
+
+  shadow.reg.POWERCFG.bits.DMUTE    = 0;      // Disable Mute
+  shadow.reg.POWERCFG.bits.ENABLE   = 1;      // PowerDown Enable=1
+  shadow.reg.POWERCFG.bits.DISABLE  = 1;      // PowerDown Disable=1
+  _dirty |= REG_CTRL_MASK;                    // Mark registers as changed
+  
+  byte err = putShadow();                     // Write to registers
+  delay(2);                                   // wait for max power down time
+  return err;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Reset the Si4703 into the bus mode of the transport and power it up with the default configuration
+// The bus mode (2-wire or 3-wire) is selected by SDIO at the rising edge of RST, so RST must be controlled.
+// The breakout board has SEN and SDIO pulled high, after a normal power up the mode is unknown.
+// The GPIO2 interrupt is released and its capture queue dropped, enable it again after start().
+// Returns ERR_NONE, or the error of powerUp() or of the configuration write
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::start() 
+{
+  STATS_BLOCK(STATS_START);
+
+  cancel();     // Abort any async tune/seek in progress
+  releaseISR(); // The reset disables the GPIO2 interrupt
+  _rdsHead    = 0;        // Drop the interrupt capture queue
+  _rdsTail    = 0;
+  _rdsPending = false;
+  _stcInt     = false;
+
+  _bus.select(_rstPin);   // Reset into 2-wire or 3-wire mode
+  byte err = powerUp();   // Power Up device
+  if (err) return err;
+
+  // Default Start Configuration (shadow was primed by powerUp)
+
+  // Select region band
+  shadow.reg.SYSCONFIG2.bits.SPACE  = _region.space();  // Select Channel Spacing Type
+  shadow.reg.SYSCONFIG2.bits.BAND   = _region.band();   // Select Band frequency range
+  shadow.reg.SYSCONFIG1.bits.DE     = _region.de();     // Select de-emphasis                          
+
+  // Set Tune
+  shadow.reg.SYSCONFIG1.bits.STCIEN = 0;            // Disable Seek/Tune Complete Interrupt
+
+  // Set seek mode
+  shadow.reg.POWERCFG.bits.SEEK     = 0;            // Disable Seek
+  shadow.reg.POWERCFG.bits.SEEKUP   = 1;            // Seek direction = UP
+  shadow.reg.POWERCFG.bits.SKMODE   = _skmode;      // Seek mode Wrap/Stop
+  shadow.reg.SYSCONFIG2.bits.SEEKTH = _seekth;      // Seek Threshold
+  shadow.reg.SYSCONFIG3.bits.SKCNT  = _skcnt;       // Seek Clicks Number Threshold
+  shadow.reg.SYSCONFIG3.bits.SKSNR  = _sksnr;       // Seek Signal/Noise Ratio
+  shadow.reg.SYSCONFIG1.bits.AGCD   = _agcd;        // AGC Disable
+
+  // Set RDS mode
+  shadow.reg.SYSCONFIG1.bits.RDSIEN = 0;            // Enable/Disable RDS Interrupt
+  shadow.reg.POWERCFG.bits.RDSM     = 1;            // RDS Mode Verbose, BLERA-BLERD are reported for the decoder
+  shadow.reg.SYSCONFIG1.bits.RDS    = 1;            // Enable/Disable RDS
+
+  // Set Audio
+  shadow.reg.TEST1.bits.AHIZEN      = 0;            // Enable Audio
+  shadow.reg.POWERCFG.bits.MONO     = 0;            // Disable MONO Mode
+  shadow.reg.SYSCONFIG1.bits.BLNDADJ= BLA_31_49;    // Stereo/Mono Blend Level Adjustment 31–49 RSSI dBμV (default)
+  shadow.reg.SYSCONFIG2.bits.VOLUME = 0;            // Set volume to 0
+  shadow.reg.SYSCONFIG3.bits.VOLEXT = 0;            // disabled (default)
+  
+  // Set Softmute mode
+  shadow.reg.POWERCFG.bits.DSMUTE   = 1;            // Disable Softmute
+  shadow.reg.SYSCONFIG3.bits.SMUTEA = SMA_16dB;     // Softmute Attenuation 16dB (default)
+  shadow.reg.SYSCONFIG3.bits.SMUTER = SMRR_Fastest; // Softmute Attack/Recover Rate = Fastest (default)
+
+  // Set GPIOs
+  shadow.reg.SYSCONFIG1.bits.GPIO1  = GPIO_Z;       // GPIO1 = High impedance (default)
+  shadow.reg.SYSCONFIG1.bits.GPIO2  = GPIO_Z;       // GPIO2 = High impedance (default)
+  shadow.reg.SYSCONFIG1.bits.GPIO3  = GPIO_Z;       // GPIO3 = High impedance (default)
+
+  _dirty |= REG_CTRL_MASK;                          // Mark registers as changed
+  return putShadow();                               // Write to registers
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Warm start: adopt a device that is still running, e.g. after an MCU only reset
+// The register set is read without a reset (one 32 byte read). If it is a powered up Si4703 with this
+// instance's band, spacing and de-emphasis, its state (channel, volume, GPIOs, ...) is adopted as is.
+// Otherwise falls back to start(). Returns true if the running device was adopted.
+// Start-up time: warm ~3ms at 100kHz I2C, cold start() 2ms reset + oscillator settle (500ms) + power up (<=110ms).
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::warmStart()
+{
+  STATS_BLOCK(STATS_WARMSTART);
+
+  _asleep = false;                                  // Adopts the device state
+  pinMode(_rstPin, OUTPUT);                         // Reset pin
+  digitalWrite(_rstPin, HIGH);                      // Keep the device out of reset
+  _bus.begin();                                     // Device is still in the bus mode of its last reset
+
+  bool running = (getShadow() == ERR_NONE)          && // Read the current register set
+                 (shadow.reg.DEVICEID.word == DEVICEID_SI4703) &&
+                 shadow.reg.POWERCFG.bits.ENABLE     && !shadow.reg.POWERCFG.bits.DISABLE &&
+                 isPoweredUp()                       &&
+                 (shadow.reg.SYSCONFIG2.bits.BAND  == _region.band())  &&
+                 (shadow.reg.SYSCONFIG2.bits.SPACE == _region.space()) &&
+                 (shadow.reg.SYSCONFIG1.bits.DE    == _region.de());
+  if (!running)
+    {
+      _error = ERR_NONE;                            // A failed probe is expected here
+      start();                                      // Cold start, errors in getError()
+      return false;
+    }
+
+  if (shadow.reg.CHANNEL.bits.TUNE || shadow.reg.POWERCFG.bits.SEEK)
+    {                                               // MCU was reset during tune/seek
+      shadow.reg.CHANNEL.bits.TUNE  = 0;            // Clear Tune bit
+      shadow.reg.POWERCFG.bits.SEEK = 0;            // Stop seek
+      _dirty |= (1 << REG_POWERCFG) | (1 << REG_CHANNEL);
+      putShadow();                                  // Write to registers
+    }
+
+  bool stcien = shadow.reg.SYSCONFIG1.bits.STCIEN;
+  bool rdsien = shadow.reg.SYSCONFIG1.bits.RDSIEN;
+  if ((stcien || rdsien) && !setGPIO2Int(stcien, rdsien))
+    {                                               // No ISR for intPin: back to polling
+      shadow.reg.SYSCONFIG1.bits.STCIEN = 0;        // Disable Seek/Tune Complete Interrupt
+      shadow.reg.SYSCONFIG1.bits.RDSIEN = 0;        // Disable RDS Interrupt
+      shadow.reg.SYSCONFIG1.bits.GPIO2  = GPIO_Z;   // GPIO2 = High impedance (default)
+      _dirty |= (1 << REG_SYSCONFIG1);              // Mark register as changed
+      putShadow();                                  // Write to registers
+    }
+
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Power down and keep the state to resume: the shadow keeps the registers as they were before, with the channel.
+// Setters still change the shadow while asleep, resume() takes the changes along. Tune/seek resume first.
+// The crystal keeps running in power down while XOSCEN is set, so resume() doesn't wait for it to settle.
+// Returns ERR_NONE or ERR_BUS (still awake: the channel read failed, or the power down write with the state
+// written back by the next write)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::sleep(void)
+{
+  if (_asleep) return ERR_NONE;
+
+  cancel();                                         // Abort any async tune/seek in progress
+  if (readStatus(2)) return ERR_BUS;                // READCHAN: channel to retune (also after a seek)
+  _sleepChan = shadow.reg.READCHAN.bits.READCHAN;
+
+  uint16_t keep[6];
+  memcpy(keep, &shadow.word[8], sizeof(keep));      // Registers 0x02-0x07 before power down
+  byte err = powerDown();
+  memcpy(&shadow.word[8], keep, sizeof(keep));      // The shadow keeps them, the device doesn't
+  if (err) return err;                              // Still dirty: the next write restores them
+
+  _asleep = true;
+  return ERR_NONE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Power up from sleep() and retune the channel before it
+// One write of the registers as they were before sleep() (with any setter changes since), the power up
+// (up to 110ms, polled) and a tune of the channel (60ms). No reset, no oscillator settle time and no
+// configuration writes as with start(). When awake it only restarts the idle timeout.
+// Returns ERR_NONE, ERR_BUS or ERR_TIMEOUT
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::resume(void)
+{
+  STATS_BLOCK(STATS_RESUME);
+
+  _lastActive = millis();
+  if (!_asleep) return ERR_NONE;
+
+  byte err = wake();
+  if (err) return err;
+  if (!tunePreset(_sleepChan)) return _error;      // Retune
+  return ERR_NONE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Power up from sleep(): write all control registers as kept in the shadow, with ENABLE, and wait for power up
+// Returns ERR_NONE, ERR_BUS (still asleep) or ERR_TIMEOUT
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::wake(void)
+{
+  shadow.reg.POWERCFG.bits.ENABLE   = 1;            // Powerup Enable=1
+  shadow.reg.POWERCFG.bits.DISABLE  = 0;            // Powerup Disable=0
+  _dirty |= REG_CTRL_MASK;                          // Whole state in one write
+  _asleep = false;
+  if (putShadow())
+    {
+      _asleep = true;
+      return ERR_BUS;
+    }
+  return waitPowerUp();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Returns true between sleep() and resume()
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::isAsleep(void)
+{
+  return _asleep;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// sleep() from poll() after ms without a register write (setters, tune, seek) or resume(), 0 = never
+// Call resume() on user input that doesn't change the radio to keep it awake.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::setIdleTimeout(unsigned long ms)
+{
+  _idleTimeout = ms;
+  _lastActive  = millis();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Save the configuration to buf[STATE_SIZE], e.g. per listening profile or in EEPROM:
+//   buf[0]      STATE_VERSION
+//   buf[1-12]   registers 0x02-0x07 MSB first, CHANNEL with the channel tuned (READCHAN, also after a seek)
+//   buf[13]     complement of the sum of buf[0-12]
+// Band, spacing, de-emphasis and the seek settings of the constructor are taken from the registers.
+// One 4 byte read of READCHAN, none while asleep. Returns ERR_NONE or ERR_BUS
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::saveState(uint8_t *buf)
+{
+  if (!_asleep && readStatus(2)) return ERR_BUS;    // READCHAN: channel tuned
+  uint16_t chan = _asleep ? _sleepChan : shadow.reg.READCHAN.bits.READCHAN;
+
+  buf[0] = STATE_VERSION;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      uint16_t w = shadow.word[8 + i];              // Registers 0x02-0x07
+      if (i == REG_CHANNEL - REG_POWERCFG) w = chan;    // TUNE clear
+      buf[1 + 2 * i] = w >> 8;
+      buf[2 + 2 * i] = w & 0xFF;
+    }
+  buf[STATE_SIZE - 1] = stateSum(buf);
+  return ERR_NONE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Apply a configuration saved by saveState(), including fields without a setter (BLNDADJ, SMUTEA, SMUTER, ...)
+// All control registers go out in one write, which also starts the tune if the channel, band or spacing differs.
+// Power state, seek/tune, GPIO2 and its interrupts (STCIEN, RDSIEN) and XOSCEN are kept as they are.
+// A runtime region takes the band, spacing and de-emphasis of the blob (and learns tune/seek times again),
+// a fixed region only accepts its own. While asleep the state is kept for resume(), without bus traffic.
+// Returns ERR_NONE, ERR_STATE (nothing changed), ERR_BUS or ERR_TIMEOUT
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::restoreState(const uint8_t *buf)
+{
+  // Taken from the blob: all but the power, seek/tune, GPIO2 and interrupt bits, and XOSCEN
+  static const uint16_t mask[6] = { 0xEE00,         // POWERCFG:   DSMUTE, DMUTE, MONO, RDSM, SKMODE, SEEKUP
+                                    0x0000,         // CHANNEL:    tuned separately
+                                    0x1CF3,         // SYSCONFIG1: RDS, DE, AGCD, BLNDADJ, GPIO3, GPIO1
+                                    0xFFFF,         // SYSCONFIG2: SEEKTH, BAND, SPACE, VOLUME
+                                    0xF1FF,         // SYSCONFIG3: SMUTER, SMUTEA, VOLEXT, SKSNR, SKCNT
+                                    0x4000 };       // TEST1:      AHIZEN
+  uint16_t w[6];
+  for (uint8_t i = 0; i < 6; i++)
+    w[i] = (buf[1 + 2 * i] << 8) | buf[2 + 2 * i];
+
+  SYSCONFIG1_t  cfg1;
+  SYSCONFIG2_t  cfg2;
+  CHANNEL_t     channel;
+  cfg1.word    = w[REG_SYSCONFIG1 - REG_POWERCFG];
+  cfg2.word    = w[REG_SYSCONFIG2 - REG_POWERCFG];
+  channel.word = w[REG_CHANNEL - REG_POWERCFG];
+
+  Region region = _region;
+  region.set(cfg2.bits.BAND, cfg2.bits.SPACE, cfg1.bits.DE);   // Ignored by a fixed region
+  if (buf[0] != STATE_VERSION || buf[STATE_SIZE - 1] != stateSum(buf) ||
+      cfg2.bits.BAND > BAND_JP || cfg2.bits.SPACE > SPACE_50KHz ||
+      region.band() != cfg2.bits.BAND || region.space() != cfg2.bits.SPACE || region.de() != cfg1.bits.DE ||
+      channel.bits.CHAN > region.chan(region.end()))
+    return (_error = ERR_STATE);
+
+  cancel();                                         // Abort any async tune/seek in progress
+  if (!_asleep && readStatus(2)) return ERR_BUS;    // READCHAN: tune only if another channel
+
+  bool retune = (channel.bits.CHAN != shadow.reg.READCHAN.bits.READCHAN);
+  if (region.band() != _region.band() || region.space() != _region.space())
+    {
+      _tuneUs     = TUNE_US;                        // Learned per band and spacing
+      _seekChanUs = SEEK_CHAN_US;
+      retune      = true;
+    }
+  _region = region;
+
+  for (uint8_t i = 0; i < 6; i++)
+    shadow.word[8 + i] = (shadow.word[8 + i] & ~mask[i]) | (w[i] & mask[i]);
+  _dirty |= REG_CTRL_MASK;                          // Whole profile in one write
+
+  _skmode = shadow.reg.POWERCFG.bits.SKMODE;        // Seek settings for a later start()
+  _seekth = shadow.reg.SYSCONFIG2.bits.SEEKTH;
+  _skcnt  = shadow.reg.SYSCONFIG3.bits.SKCNT;
+  _sksnr  = shadow.reg.SYSCONFIG3.bits.SKSNR;
+  _agcd   = shadow.reg.SYSCONFIG1.bits.AGCD;
+
+  if (_asleep)
+    {
+      _sleepChan = channel.bits.CHAN;               // Written and tuned by resume()
+      return ERR_NONE;
+    }
+  if (!retune) return putShadow();
+  if (!tunePreset(channel.bits.CHAN, true)) return _error;    // Registers and TUNE in one write
+  return ERR_NONE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Check byte of a saveState() blob: complement of the sum of the bytes before it
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+uint8_t Si4703T<Bus, Region>::stateSum(const uint8_t *buf)
+{
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i < STATE_SIZE - 1; i++)
+    sum += buf[i];
+  return ~sum;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Enable/Disable Seek/Tune Complete interrupt
+// GPIO2 is configured as STC/RDS interrupt output and the ISR is attached to intPin, so tune and seek
+// wait on a flag instead of polling STC over I2C.
+// Returns false when enabling if intPin can't generate interrupts or another instance of this type has the
+// interrupt. Disabling always clears the interrupt bits and GPIO2.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::setInterrupt(bool en)
+{
+  return setGPIO2Int(en, shadow.reg.SYSCONFIG1.bits.RDSIEN);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Enable/Disable RDS interrupt capture
+// Every RDS group is read by the ISR (0x0A - 0x0F only) into a queue of RDS_QUEUE_LEN groups, drain it with
+// readGroup() or readRDS(). When the ISR finds the bus busy, the group is read as soon as the bus is released.
+// A tune or seek drops the groups still queued from the channel left.
+// With SI4703_ISR_BUS (AVR) the ISR uses Wire with interrupts enabled again, which needs a Wire implementation
+// that allows it. Otherwise the group is read by the next readRDS(), readGroup(), getGroupCount() or poll(), which
+// then has to come before the next group, like readRDS() without the interrupt.
+// Returns false when enabling if intPin can't generate interrupts or another instance of this type has the
+// interrupt. Disabling always clears the interrupt bits and GPIO2.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::setRDSInterrupt(bool en)
+{
+  return setGPIO2Int(shadow.reg.SYSCONFIG1.bits.STCIEN, en);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Configure GPIO2 interrupt sources and attach/detach the ISR on intPin
+// The ISR is a static of the type, so it serves one instance: another one taking it would leave the first
+// waiting for an interrupt that never comes, so that is refused.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::setGPIO2Int(bool stcien, bool rdsien)
+{
+  if (stcien || rdsien)
+    {
+      int irq = digitalPinToInterrupt(_intPin);
+      if (irq == NOT_AN_INTERRUPT) return false;    // intPin has no external interrupt
+      if (_isrRadio && _isrRadio != this)
+        return false;                               // The ISR serves another instance
+
+      _isrRadio = this;                             // Route the ISR to this instance
+      _stcInt   = false;                            // Clear any old interrupt
+      pinMode(_intPin, INPUT);                      // GPIO2 drives the pin high, pulses low on interrupt
+      attachInterrupt(irq, isrGPIO2, FALLING);      // Call isrGPIO2() on falling edge
+      shadow.reg.SYSCONFIG1.bits.GPIO2  = GPIO_I;   // GPIO2 = STC/RDS interrupt
+    }
+  else
+    {
+      releaseISR();                                 // Stop serving intPin
+      shadow.reg.SYSCONFIG1.bits.GPIO2  = GPIO_Z;   // GPIO2 = High impedance (default)
+    }
+  shadow.reg.SYSCONFIG1.bits.STCIEN = stcien;       // Enable/Disable Seek/Tune Complete Interrupt
+  shadow.reg.SYSCONFIG1.bits.RDSIEN = rdsien;       // Enable/Disable RDS Interrupt
+
+  _dirty |= (1 << REG_SYSCONFIG1);                  // Mark register as changed
+  putShadow();                                      // Write to registers
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Detach the ISR from intPin if it serves this instance, so another instance of this type can take it
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::releaseISR(void)
+{
+  if (_isrRadio != this) return;
+  int irq = digitalPinToInterrupt(_intPin);
+  if (irq != NOT_AN_INTERRUPT) detachInterrupt(irq);
+  _isrRadio = NULL;                                 // Free for another instance
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// GPIO2 interrupt service routine
+// STC only: just flag it, the bus is read outside the ISR.
+// RDS capture: read the group now (SI4703_ISR_BUS), or leave it pending if the bus is in use or can't be used here.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::isrGPIO2(void)
+{
+  Si4703T* radio = _isrRadio;
+  if (!radio) return;
+
+  if (!radio->shadow.reg.SYSCONFIG1.bits.RDSIEN)    // STC interrupt only
+    radio->_stcInt = true;
+  else if (radio->_busLock || !SI4703_ISR_BUS)      // Bus in use or not from the ISR, capture later
+    {
+      radio->_stcInt     = true;                    // Might be STC, will be confirmed
+      radio->_rdsPending = true;
+    }
+#if SI4703_ISR_BUS
+  else
+    radio->captureRDS(true);                        // Capture group now
+#endif
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Capture an RDS group the ISR left pending, unless a bus transaction is in progress (it is captured on release)
+// The bus is locked together with the check, so the ISR can't capture the same group in between.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::servePending(void)
+{
+  noInterrupts();                                   // Pending and the lock are tested by the ISR
+  bool serve = _rdsPending && !_busLock;
+  if (serve) _busLock = true;
+  interrupts();
+  if (serve) captureRDS(false);                     // Unlocks when done
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Read one RDS group from the interrupt capture queue
+// Returns false if the queue is empty
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::readGroup(rdsGroup_t &g)
+{
+  servePending();
+  if (_rdsTail == _rdsHead) return false;           // Empty
+
+  g = _rdsQueue[_rdsTail & (RDS_QUEUE_LEN - 1)];
+  _rdsTail++;                                       // Free the slot after copying
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Drop the groups in the interrupt capture queue, and a capture left pending, when leaving the channel
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::flushRDS(void)
+{
+  noInterrupts();                                   // Head and pending are updated by the ISR
+  _rdsTail    = _rdsHead;
+  _rdsPending = false;
+  interrupts();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get number of RDS groups available in the interrupt capture queue
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getGroupCount(void)
+{
+  servePending();
+  return (uint8_t)(_rdsHead - _rdsTail);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get number of RDS groups lost because the capture queue was full
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+uint16_t	Si4703T<Bus, Region>::getRDSOverflow(void)
+{
+  noInterrupts();                                   // 16 bit counter is updated by the ISR
+  uint16_t n = _rdsOverflow;
+  interrupts();
+  return n;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set Mono
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::setMono(bool en)
+{
+  if (shadow.reg.POWERCFG.bits.MONO == en) return; // No change, skip the write
+  shadow.reg.POWERCFG.bits.MONO = en;     // 1 = Force Mono
+  _dirty |= (1 << REG_POWERCFG);          // Mark register as changed
+  updateShadow();                          // Write to registers, or defer until commit()
+}	
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Mono Status
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::getMono(void)
+{
+  return (shadow.reg.POWERCFG.bits.MONO);   // return cached status
+}	
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set Audio Mute
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::setMute(bool en)
+{
+  if (shadow.reg.POWERCFG.bits.DMUTE == en) return; // No change, skip the write
+  shadow.reg.POWERCFG.bits.DMUTE = en;      // 0= Mute disabled
+  _dirty |= (1 << REG_POWERCFG);            // Mark register as changed
+  updateShadow();                            // Write to registers, or defer until commit()
+}	
+//-----------------------------------------------------------------------------------------------------------------------------------
+// get Audio Mute
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::getMute(void)
+{
+  return (shadow.reg.POWERCFG.bits.DMUTE);  // return cached status
+}	
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set Extended Volume Range
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::setVolExt(bool en)
+{
+  if (shadow.reg.SYSCONFIG3.bits.VOLEXT == en) return; // No change, skip the write
+  shadow.reg.SYSCONFIG3.bits.VOLEXT = en;   // 0=disabled (default)
+  _dirty |= (1 << REG_SYSCONFIG3);          // Mark register as changed
+  updateShadow();                            // Write to registers, or defer until commit()
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Extended Volume Range
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::getVolExt(void)
+{
+  return (shadow.reg.SYSCONFIG3.bits.VOLEXT);// return cached status
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Current Volume
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::getVolume(void)
+{
+  return(shadow.reg.SYSCONFIG2.bits.VOLUME);  // return cached value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set Volume
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::setVolume(int volume)
+{
+  if (volume < 0 ) volume = 0;                // Accepted Volume value 0-15
+  if (volume > 15) volume = 15;               // Accepted Volume value 0-15
+  if (shadow.reg.SYSCONFIG2.bits.VOLUME == volume) return(volume); // No change, skip the write
+  shadow.reg.SYSCONFIG2.bits.VOLUME = volume; // Set volume
+  _dirty |= (1 << REG_SYSCONFIG2);            // Mark register as changed
+  updateShadow();                              // Write to registers, or defer until commit()
+  return(getVolume());
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Increment Volume
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::incVolume(void)
+{
+  return(setVolume(getVolume()+1));
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Decrement Volume
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::decVolume(void)
+{
+  return(setVolume(getVolume()-1));
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Reads the current channel from READCHAN
+// Returns a number like 974 for 97.4MHz, or 0 on a bus error (see getError())
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::getChannel()
+{
+  if (readStatus(2)) return 0;                // Read STATUSRSSI and READCHAN (4 bytes)
+  
+  // Freq = Spacing * Channel + Bottom of Band.
+  return _region.freq(shadow.reg.READCHAN.bits.READCHAN);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Sets Channel frequency
+// Blocking wrapper over beginTune()/poll(), waits at most the tune timeout (see setTimeout())
+// Returns zero on a bus error or timeout, see getError()
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::setChannel(int freq)
+{
+  STATS_BLOCK(STATS_TUNE);
+
+  cancel();                                 // Abort any async tune/seek in progress
+  if (!beginTune(freq)) return 0;           // Start tuning
+  while(poll()) yield();                    // Wait for tune to complete
+
+  return _asyncFreq;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Tunes a preset: a CHAN word from getPresetWord()
+// Blocking wrapper over beginPreset()/poll(). Audio is on the new channel after STC; without verify the only
+// bus traffic is the tune write, the STC polls (or none with the interrupt) and the TUNE clear write.
+// Returns zero on a bus error or timeout, see getError()
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::tunePreset(uint16_t chan, bool verify)
+{
+  STATS_BLOCK(STATS_TUNE);
+
+  cancel();                                 // Abort any async tune/seek in progress
+  if (!beginPreset(chan, NULL, verify)) return 0; // Start tuning
+  while(poll()) yield();                    // Wait for tune to complete
+
+  return _asyncFreq;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Increment frequency one band step
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::incChannel(void)
+{
+  int freq = getChannel();
+  if (!freq) return 0;                                 // Bus error
+  return setChannel(freq + _region.spacing());         // Increment frequency one band step
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Decrement frequency one band step
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::decChannel(void)
+{
+  int freq = getChannel();
+  if (!freq) return 0;                                 // Bus error
+  return setChannel(freq - _region.spacing());         // Decrement frequency one band step
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get STC status
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::getSTC(void)
+{
+  STATS_ADD(stcPolls, 1);
+  if (readStatus(1)) return false;              // Read STATUSRSSI only (2 bytes), retry on the next poll
+  return(shadow.reg.STATUSRSSI.bits.STC);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Check for STC (Seek/Tune Complete) without blocking
+// With STCIEN=1 the bus is only read after a GPIO2 interrupt. GPIO2 is shared with the RDS interrupt,
+// so every interrupt is confirmed with a 2 byte STATUSRSSI read.
+// STATUSRSSI in shadow is current when it returns true.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::checkSTC(void)
+{
+  if (shadow.reg.SYSCONFIG1.bits.STCIEN == 0)   // Select method Interrupt or STC
+    return getSTC();                            // Poll the si4703 STC
+
+  if (!_stcInt) return false;                   // No bus traffic while waiting for interrupt
+  _stcInt = false;                              // Clear flag for next interrupt
+  return getSTC();                              // Confirm it was STC
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Check STC and report seek progress: one 4 byte read of STATUSRSSI and READCHAN per poll, also with the interrupt
+// READCHAN follows the channel being examined while seeking.
+// Returns true if the seek completed (STC) or the callback aborted it
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::checkSeek(void)
+{
+  STATS_ADD(stcPolls, 1);
+  _stcInt = false;                              // STC is read anyway
+  if (readStatus(2)) return false;              // Read STATUSRSSI and READCHAN (4 bytes), retry on the next poll
+
+  _seekFreq = _region.freq(shadow.reg.READCHAN.bits.READCHAN);
+  if (shadow.reg.STATUSRSSI.bits.STC) return true;
+  return !_seekProgress(_seekFreq);             // false from the callback aborts
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Seeks the next available station
+// Blocking wrapper over beginSeek()/poll(), waits at most the seek timeout (see setTimeout())
+// Returns freq if seek succeeded
+// Returns zero if seek failed, or on a bus error or timeout (see getError())
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::seek(byte seekDirection){
+
+  STATS_BLOCK(STATS_SEEK);
+
+  cancel();                                 // Abort any async tune/seek in progress
+  if (!beginSeek(seekDirection)) return 0;  // Start seeking
+  while(poll()) yield();                    // Wait for seek to complete
+
+  if(_asyncSFBL)  return(0);                // Failure: SFBL is indicating we hit a band limit or failed to find a station
+  return _asyncFreq;                        // Success: return new frequency
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------
+// Seek Up
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::seekUp()
+{
+	return seek(SEEK_UP);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Seek Down
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::seekDown()
+{
+	return seek(SEEK_DOWN);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Start tuning to a Channel frequency without waiting
+// Call poll() until it returns false, done(freq, sfbl) is called on completion, or done(0, true) on a timeout.
+// Returns false if a tune/seek is already in progress or the register write failed
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::beginTune(int freq, tuneCallback_t done)
+{
+  return beginPreset(getPresetWord(freq), done, true);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get the CHAN register word of a channel, clamped to the band
+// Store it per preset and tune it with tunePreset()/beginPreset() to skip the clamping and division.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+uint16_t Si4703T<Bus, Region>::getPresetWord(int freq)
+{
+  if (freq > _region.end())    freq = _region.end();    // check upper limit
+  if (freq < _region.start())  freq = _region.start();  // check lower limit
+
+  // Freq     = Spacing * Channel + bandStart.
+  // Channel  = (Freq - bandStart) / Spacing
+  return _region.chan(freq);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Start tuning a CHAN word without waiting
+// Writes POWERCFG and CHANNEL only (4 bytes). Without verify the tune ends with the TUNE clear write after STC:
+// the channel is known and STC clears with TUNE, so the STC clear read of beginTune() is skipped.
+// Call poll() until it returns false, done(freq, false) is called on completion, or done(0, true) on a timeout.
+// Returns false if a tune/seek is already in progress or the register write failed
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::beginPreset(uint16_t chan, tuneCallback_t done, bool verify)
+{
+  if (_asyncState != ASYNC_IDLE) return false;  // Busy
+  if (_asleep && wake()) return false;          // Power up first (blocks up to 110ms)
+
+  shadow.reg.CHANNEL.bits.CHAN  = chan;
+  shadow.reg.CHANNEL.bits.TUNE  = 1;        // Set the TUNE bit to start
+  _dirty |= (1 << REG_CHANNEL);             // Mark register as changed
+  _stcInt = false;                          // Clear any old interrupt
+  if (putShadow())                          // Write to registers
+    {
+      shadow.reg.CHANNEL.bits.TUNE = 0;     // Not started, don't send TUNE with a later write
+      return false;
+    }
+
+  rds.reset();                              // New channel, old RDS data is invalid
+  flushRDS();                               // So are the groups captured on it
+  if (_rdsStats) _rdsStats->tuned(0);       // Off the channel until done
+  _asyncState = ASYNC_TUNE;                 // Wait for STC
+  _asyncDone  = done;                       // Completion callback
+  _asyncVerify= verify;
+  _asyncSFBL  = false;
+  _asyncStart = millis();                   // Start of timeout
+  _asyncLimit = _tuneTimeout;
+  _asyncUs    = micros();                   // First poll when the tune is expected to be done
+  _pollAt     = _tuneUs;
+  _pollStep   = POLL_MIN_US;
+  _seekFrom   = -1;
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Start seeking the next available station without waiting
+// Call poll() until it returns false, done(freq, sfbl) is called on completion, or done(0, true) on a timeout.
+// Returns false if a tune/seek is already in progress or the register write failed
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::beginSeek(byte seekDirection, tuneCallback_t done)
+{
+  if (_asyncState != ASYNC_IDLE) return false;      // Busy
+  if (_asleep && resume()) return false;            // Power up on the channel before first (blocks up to 170ms)
+
+  shadow.reg.POWERCFG.bits.SEEKUP = seekDirection;  // Seek direction = UP/Down
+  shadow.reg.POWERCFG.bits.SEEK   = 1;              // Start seek
+  _dirty |= (1 << REG_POWERCFG);                    // Mark register as changed
+  _stcInt = false;                                  // Clear any old interrupt
+  if (putShadow())                                  // Write to registers to start seeking
+    {
+      shadow.reg.POWERCFG.bits.SEEK = 0;            // Not started, don't send SEEK with a later write
+      return false;
+    }
+
+  rds.reset();                                      // New channel, old RDS data is invalid
+  flushRDS();                                       // So are the groups captured on it
+  if (_rdsStats) _rdsStats->tuned(0);               // Off the channel until done
+  _asyncState = ASYNC_SEEK;                         // Wait for STC
+  _asyncDone  = done;                               // Completion callback
+  _asyncSFBL  = false;
+  _asyncStart = millis();                           // Start of timeout
+  _asyncLimit = _seekTimeout;
+  _asyncUs    = micros();                           // Poll once per channel, just after it is done
+  _pollStep   = _seekChanUs;
+  _pollAt     = _seekChanUs + _seekChanUs / 8;
+  _seekFrom   = shadow.reg.READCHAN.bits.READCHAN;  // Channel of the last tune/seek
+  _seekFreq   = 0;
+  return true;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Advance the tune/seek in progress, call repeatedly from loop()
+// Each call does at most one status read and one register write (with retries) and never waits.
+// Without the interrupt STC is only read when it is expected: after the learned tune time, then backing off from
+// 250us to 2ms, and for a seek once per channel examined. Calls in between don't use the bus.
+// A tune/seek that doesn't complete within its timeout is stopped with ERR_TIMEOUT.
+// Returns true while busy
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::poll(void)
+{
+  servePending();                                   // RDS group flagged by the ISR (SI4703_ISR_BUS 0)
+  if (_asyncState != ASYNC_IDLE && millis() - _asyncStart > _asyncLimit)
+    return asyncFail(ERR_TIMEOUT);                  // STC never came (or never cleared)
+  if (_asyncState != ASYNC_IDLE && !pollDue()) return true;
+
+  switch (_asyncState)
+  {
+    case ASYNC_SEEK:                                // Waiting for the si4703 to set the STC
+      if (_seekProgress ? !checkSeek() : !checkSTC())
+        {
+          pollNext();
+          return true;
+        }
+
+      // Save SFBL status, a seek aborted by the progress callback (no STC) failed
+      _asyncSFBL = shadow.reg.STATUSRSSI.bits.SFBL || !shadow.reg.STATUSRSSI.bits.STC;
+      _asyncTook = micros() - _asyncUs;
+      shadow.reg.POWERCFG.bits.SEEK   = 0;          // Stop seek
+      _dirty |= (1 << REG_POWERCFG);                // Mark register as changed
+      putShadow();                                  // Write to registers, retried in ASYNC_CLEAR if it failed
+      _asyncState = ASYNC_CLEAR;                    // Wait for the si4703 to clear the STC
+      _pollAt     = 0;                              // Right away
+      _pollStep   = POLL_MIN_US;
+      return true;
+
+    case ASYNC_TUNE:                                // Waiting for the si4703 to set the STC
+      if (!checkSTC())
+        {
+          pollNext();
+          return true;
+        }
+
+      learnTune(micros() - _asyncUs);
+      shadow.reg.CHANNEL.bits.TUNE  = 0;            // Clear Tune bit
+      _dirty |= (1 << REG_CHANNEL);                 // Mark register as changed
+      if (putShadow() == ERR_NONE && !_asyncVerify) // Preset: done, STC clears with TUNE
+        {
+          STATS_ADD(tunes, 1);
+          STATS_ADD(tuneUs, micros() - _asyncUs);
+          _asyncFreq  = _region.freq(shadow.reg.CHANNEL.bits.CHAN);
+          _asyncState = ASYNC_IDLE;                 // Done
+          if (_rdsStats) _rdsStats->tuned(_asyncFreq);
+          if (_asyncDone) _asyncDone(_asyncFreq, false);
+          return false;
+        }
+      _asyncState = ASYNC_CLEAR;                    // Wait for the si4703 to clear the STC, retry a failed write
+      _pollAt     = 0;                              // Right away
+      _pollStep   = POLL_MIN_US;
+      return true;
+
+    case ASYNC_CLEAR:                               // Waiting for the si4703 to clear the STC
+      if ((_dirty & REG_CTRL_MASK) && putShadow()) return true;  // TUNE/SEEK not cleared yet
+      if (readStatus(2)) return true;               // Read STATUSRSSI and READCHAN (4 bytes)
+      if (shadow.reg.STATUSRSSI.bits.STC)
+        {
+          pollNext();
+          return true;
+        }
+
+      if (_seekFrom < 0)
+        {
+          STATS_ADD(tunes, 1);
+          STATS_ADD(tuneUs, micros() - _asyncUs);
+        }
+      else
+        {
+          if (!_asyncSFBL) learnSeek(_asyncTook);   // Channels examined are known now from READCHAN
+          STATS_ADD(seeks, 1);
+          STATS_ADD(seekUs, micros() - _asyncUs);
+        }
+      _asyncFreq  = _region.freq(shadow.reg.READCHAN.bits.READCHAN);
+      _asyncState = ASYNC_IDLE;                     // Done
+      if (_rdsStats) _rdsStats->tuned(_asyncFreq);
+      if (_asyncDone) _asyncDone(_asyncFreq, _asyncSFBL);
+      return false;
+
+    default:                                        // Idle: power down after the idle timeout
+      if (_idleTimeout && !_asleep && millis() - _lastActive >= _idleTimeout) sleep();
+      return false;
+  }
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// The next poll is due: always with the STC interrupt (checkSTC() only reads after one), else on the schedule.
+// A seek with progress reads on every poll, so it keeps the once per channel schedule also with the interrupt.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::pollDue(void)
+{
+  if (_asyncState != ASYNC_CLEAR && shadow.reg.SYSCONFIG1.bits.STCIEN &&
+      (_asyncState != ASYNC_SEEK || !_seekProgress || _stcInt)) return true;
+  return (micros() - _asyncUs >= _pollAt);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Schedule the next poll after one that didn't see the expected status
+// Seek: STC can only come when a channel is done, poll just after the next one. Else back off: 250us, 500us, ... 2ms.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::pollNext(void)
+{
+  unsigned long t = micros() - _asyncUs;
+
+  if (_asyncState == ASYNC_SEEK)
+    {
+      while (_pollAt <= t) _pollAt += _pollStep;    // Next channel, skips any missed by a late poll()
+      return;
+    }
+  _pollAt = t + _pollStep;
+  if (_pollStep < POLL_MAX_US) _pollStep <<= 1;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Learn the tune time: average of 8 tunes
+// When STC is already set at the first poll the tune may have been shorter, so the estimate is lowered a little
+// to find out. The first poll then comes at most a few hundred us early and the next one sees STC.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::learnTune(unsigned long took)
+{
+  if (!shadow.reg.SYSCONFIG1.bits.STCIEN && _pollStep == POLL_MIN_US)  // STC at the first poll
+    took = _tuneUs - _tuneUs / 16;
+  _tuneUs = _tuneUs + ((long)took - (long)_tuneUs) / 8;
+  if (_tuneUs < POLL_MIN_US) _tuneUs = POLL_MIN_US;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Learn the seek time per channel from a successful seek: average of 8 seeks
+// took is when STC was seen, on average half a poll interval after the seek was done.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::learnSeek(unsigned long took)
+{
+  int n    = _region.chan(_region.end()) + 1;       // Channels in the band
+  int from = _seekFrom;
+  int to   = shadow.reg.READCHAN.bits.READCHAN;
+  int k    = shadow.reg.POWERCFG.bits.SEEKUP ? to - from : from - to;
+  if (k <= 0) k += n;                               // Wrapped
+  if (k <= 0 || k >= n) return;                     // Not a channel count
+
+  if (!shadow.reg.SYSCONFIG1.bits.STCIEN) took -= _pollStep / 2;
+  _seekChanUs = _seekChanUs + ((long)(took / k) - (long)_seekChanUs) / 8;
+  if (_seekChanUs < POLL_MIN_US) _seekChanUs = POLL_MIN_US;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get the learned tune time (us)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+unsigned long Si4703T<Bus, Region>::getTuneEstimate(void)
+{
+  return _tuneUs;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get the learned seek time per channel (us)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+unsigned long Si4703T<Bus, Region>::getSeekEstimate(void)
+{
+  return _seekChanUs;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Stop the tune/seek in progress after an error, done(0, true) is called
+// Returns false (not busy) for poll()
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::asyncFail(byte err)
+{
+  shadow.reg.CHANNEL.bits.TUNE    = 0;              // Clear Tune bit
+  shadow.reg.POWERCFG.bits.SEEK   = 0;              // Stop seek
+  _dirty |= (1 << REG_POWERCFG) | (1 << REG_CHANNEL); // Mark registers as changed
+  putShadow();                                      // Best effort, stays dirty if the bus is down
+  if (err == ERR_TIMEOUT) STATS_ADD(timeouts, 1);
+
+  _error      = err;
+  _asyncFreq  = 0;
+  _asyncSFBL  = true;
+  _asyncState = ASYNC_IDLE;
+  if (_asyncDone) _asyncDone(0, true);
+  return false;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Returns true while a tune/seek is in progress
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::isBusy(void)
+{
+  return (_asyncState != ASYNC_IDLE);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Abort the tune/seek in progress, the callback is not called
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::cancel(void)
+{
+  if (_asyncState == ASYNC_IDLE) return;            // Nothing to cancel
+
+  shadow.reg.CHANNEL.bits.TUNE    = 0;              // Clear Tune bit
+  shadow.reg.POWERCFG.bits.SEEK   = 0;              // Stop seek
+  _dirty |= (1 << REG_POWERCFG) | (1 << REG_CHANNEL); // Mark registers as changed
+  putShadow();                                      // Write to registers
+  _asyncState = ASYNC_IDLE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Report the channel examined while seeking: cb(freq) is called on every seek poll (once per channel) with READCHAN.
+// Returning false stops the seek on that channel, it then completes as failed (sfbl, seek() returns 0).
+// Each report costs a 4 byte read, also with the STC interrupt enabled. NULL turns it off.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::setSeekProgress(seekProgress_t cb)
+{
+  _seekProgress = cb;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get the channel examined by the seek at the last progress report, 0 if none since beginSeek()
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::getSeekProgress(void)
+{
+  return _seekFreq;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get the result of the last async tune/seek from the status read that ended it, without bus traffic
+// Returns false if it failed: seek fail/band limit, bus error or timeout (s.freq is 0 for the last two)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::getTuned(station_t &s)
+{
+  s.freq = _asyncFreq;
+  s.rssi = shadow.reg.STATUSRSSI.bits.RSSI;
+  s.st   = shadow.reg.STATUSRSSI.bits.ST;
+  s.pi   = 0;
+  return !_asyncSFBL;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Seek RSSI Threshold
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::getSeekThreshold(void)
+{
+  return (shadow.reg.SYSCONFIG2.bits.SEEKTH);      // return cached value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Scan the whole band from getBandStart() to getBandEnd() into list, then return to the original channel
+//   SCAN_SEEK: hardware seek up with SKMODE_STOP, one entry per seek stop
+//   SCAN_STEP: tune every channel and keep local RSSI peaks at or above the seek threshold (SEEKTH)
+// RSSI and ST come from the status read that ends each tune/seek, no extra reads. If piWait > 0, RDS is
+// decoded for up to piWait ms on every station to get its PI. Audio is muted while scanning.
+// Returns the number of stations found, getScanTime() returns the duration. A bus error or timeout ends the scan.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::scanBand(station_t *list, int maxStations, uint8_t mode, unsigned int piWait)
+{
+  STATS_BLOCK(STATS_SCAN);
+
+  unsigned long start = millis();
+  int count = 0;
+
+  cancel();                                         // Abort any async tune/seek in progress
+  int  freq   = getChannel();                       // Channel to return to
+  if (!freq)                                        // Bus error: not known where to return
+    {
+      _scanTime = millis() - start;
+      return 0;
+    }
+  setScanning(true);                                // Mute, stop at band end
+
+  uint8_t seekth = shadow.reg.SYSCONFIG2.bits.SEEKTH;
+  int     ch     = setChannel(_region.start());     // Start at bottom of band
+
+  while (ch && count < maxStations)                 // ch = 0: bus error or timeout
+    {
+      uint8_t rssi = shadow.reg.STATUSRSSI.bits.RSSI;
+      bool    st   = shadow.reg.STATUSRSSI.bits.ST;
+
+      bool found = (rssi >= seekth) ||              // Seek stops are stations, except the start channel
+                   (mode == SCAN_SEEK && ch != _region.start());
+      if (found && mode == SCAN_STEP && count > 0 &&
+          list[count-1].freq == ch - _region.spacing()) // Adjacent to last station: keep the peak only
+        {
+          if (rssi > list[count-1].rssi) count--;   // Replace last station
+          else found = false;                       // Keep last station
+        }
+
+      if (found)
+        {
+          list[count].freq = ch;
+          list[count].rssi = rssi;
+          list[count].st   = st;
+          list[count].pi   = 0;
+          if (piWait)                               // Listen for PI
+            {
+              unsigned long t = millis();
+              while (rds.getPI() == 0 && millis() - t < piWait)
+                {
+                  readRDS();                        // Decode one group
+                  delay(20);                        // Groups arrive every ~88ms
+                }
+              list[count].pi = rds.getPI();
+            }
+          count++;
+        }
+
+      if (mode == SCAN_SEEK)
+        {
+          ch = seek(SEEK_UP);                       // Next station
+          if (ch == 0) break;                       // SFBL: band end reached
+        }
+      else
+        {
+          if (ch + _region.spacing() > _region.end()) break;  // Band end reached
+          ch = setChannel(ch + _region.spacing());  // Next channel
+        }
+    }
+
+  setScanning(false);                               // Restore mute and seek mode
+  setChannel(freq);                                 // Return to original channel
+
+  _scanTime = millis() - start;
+  return count;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Prepare for a band scan (en=1): mute and stop seeks at the band limit, so no seek wraps round the band.
+// en=0 restores mute and seek mode as they were. Only the shadow changes, the next tune or seek writes it.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::setScanning(bool en)
+{
+  if (en)
+    {
+      _scanDmute  = shadow.reg.POWERCFG.bits.DMUTE;   // Mute state to return to
+      _scanSkmode = shadow.reg.POWERCFG.bits.SKMODE;  // Seek mode to return to
+      shadow.reg.POWERCFG.bits.DMUTE  = 0;            // Mute while scanning
+      shadow.reg.POWERCFG.bits.SKMODE = SKMODE_STOP;  // Stop at band end
+    }
+  else
+    {
+      shadow.reg.POWERCFG.bits.DMUTE  = _scanDmute;   // Restore mute
+      shadow.reg.POWERCFG.bits.SKMODE = _scanSkmode;  // Restore seek mode
+    }
+  _dirty |= (1 << REG_POWERCFG);                    // Mark register as changed
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get duration of the last scanBand() in ms
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+unsigned long Si4703T<Bus, Region>::getScanTime(void)
+{
+  return _scanTime;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Check an Alternative Frequency of the tuned program (see Si4703_AF)
+// Audio is muted, freq is tuned and if its RSSI is at least minRSSI, RDS is decoded for up to window ms until a PI
+// is received. If it is pi the radio stays on freq, else it returns to the original channel. RDS data of the
+// original channel is lost. Time off the original channel is at most 2 tunes + window, getAFTime() returns it.
+// Returns true if the radio switched to freq
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::checkAF(int freq, uint16_t pi, uint8_t minRSSI, unsigned int window, uint8_t &rssi)
+{
+  STATS_BLOCK(STATS_TUNE);
+
+  unsigned long start = millis();
+  cancel();                                         // Abort any async tune/seek in progress
+  rssi = 0;
+  int  home  = getChannel();                        // Channel to return to
+  if (!home)                                        // Bus error: stay
+    {
+      _afTime = 0;
+      return false;
+    }
+  bool dmute = shadow.reg.POWERCFG.bits.DMUTE;      // Mute state to return to
+  shadow.reg.POWERCFG.bits.DMUTE = 0;               // Mute, written with the tune
+  _dirty |= (1 << REG_POWERCFG);                    // Mark register as changed
+
+  bool found = false;
+  if (setChannel(freq) == freq)
+    {
+      rssi = shadow.reg.STATUSRSSI.bits.RSSI;       // From the status read that ended the tune
+      unsigned long t = millis();
+      while (rssi >= minRSSI && rds.getPI() == 0 && millis() - t < window)
+        {
+          readRDS();                                // Decode one group
+          delay(10);                                // RDSR stays up for a while, groups arrive every ~88ms
+        }
+      found = (rds.getPI() == pi);
+    }
+
+  shadow.reg.POWERCFG.bits.DMUTE = dmute;           // Restore mute, written with the next tune or below
+  _dirty |= (1 << REG_POWERCFG);                    // Mark register as changed
+  if (!found) setChannel(home);                     // Return to the original channel (resets rds)
+  else        putShadow();
+
+  _afTime = millis() - start;
+  return found;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get time off the original channel during the last checkAF() in ms
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+unsigned long Si4703T<Bus, Region>::getAFTime(void)
+{
+  return _afTime;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Sterio current value
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::getST(void)
+{
+  readStatus(1);                            // Read STATUSRSSI only (2 bytes)
+  return(shadow.reg.STATUSRSSI.bits.ST);    // Return ST value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Read RDS
+// Reads STATUSRSSI..RDSD (12 bytes) and decodes one group into rds. Call at least every 40ms to catch every
+// group. RDSR stays set for a while after a group is ready, so a group seen twice in a row is only decoded once.
+// With setRDSInterrupt(true) the next captured group is taken from the queue instead, without bus traffic.
+// Returns true if a new group was accepted
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::readRDS(void)
+{ 
+  rdsGroup_t g;
+
+  if (shadow.reg.SYSCONFIG1.bits.RDSIEN)            // Groups are captured by the ISR
+    {
+      if (!readGroup(g)) return false;              // Nothing new
+      return decodeRDS(g);
+    }
+
+  uint16_t last[4] = { shadow.reg.RDSA.word, shadow.reg.RDSB.word,
+                       shadow.reg.RDSC.word, shadow.reg.RDSD.word };
+
+  if (readStatus(6)) return false;                  // Read STATUSRSSI, READCHAN and RDSA-RDSD (12 bytes)
+  if (_rdsStats) _rdsStats->sync(shadow.reg.STATUSRSSI.bits.RDSS);
+  if (!shadow.reg.STATUSRSSI.bits.RDSR)             // No group ready
+    {
+      _rdsrLast = false;
+      return false;
+    }
+
+  g.block[0] = shadow.reg.RDSA.word;
+  g.block[1] = shadow.reg.RDSB.word;
+  g.block[2] = shadow.reg.RDSC.word;
+  g.block[3] = shadow.reg.RDSD.word;
+  g.bler[0]  = shadow.reg.STATUSRSSI.bits.BLERA;
+  g.bler[1]  = shadow.reg.READCHAN.bits.BLERB;
+  g.bler[2]  = shadow.reg.READCHAN.bits.BLERC;
+  g.bler[3]  = shadow.reg.READCHAN.bits.BLERD;
+
+  bool same = _rdsrLast && memcmp(last, g.block, sizeof(last)) == 0;
+  _rdsrLast = true;
+  if (same) return false;                           // Already decoded this group
+
+  return decodeRDS(g);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Decode a group into rds and count it in the RDS statistics
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool Si4703T<Bus, Region>::decodeRDS(const rdsGroup_t &g)
+{
+  bool ok = rds.decode(g);
+  if (_rdsStats) _rdsStats->group(g, rds.hasPS());
+  return ok;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Collect RDS reception statistics per channel into stats (see Si4703_RDSStats.h), NULL = off
+// Counting starts with the next tune/seek, stats is updated from readRDS(), readSignal() and tune/seek without bus traffic.
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void Si4703T<Bus, Region>::setRDSStats(Si4703_RDSStats *stats)
+{
+  _rdsStats = stats;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Writes GPIO1-GPIO3
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::writeGPIO(int GPIO, int val)
+{
+  uint16_t old = shadow.reg.SYSCONFIG1.word;  // Keep cached value to detect a change
+
+  switch (GPIO)
+  {
+    case GPIO1:
+      shadow.reg.SYSCONFIG1.bits.GPIO1 = val;
+      break;
+
+    case GPIO2:
+      shadow.reg.SYSCONFIG1.bits.GPIO2 = val;
+      break;
+
+    case GPIO3:
+      shadow.reg.SYSCONFIG1.bits.GPIO3 = val;
+      break;
+
+    default:
+      break;
+  }
+  
+  if (shadow.reg.SYSCONFIG1.word == old) return;  // No change, skip the write
+  _dirty |= (1 << REG_SYSCONFIG1);                // Mark register as changed
+  updateShadow();                                  // Write to registers, or defer until commit()
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set the maximum time (ms) setChannel()/beginTune() and seek()/beginSeek() wait for STC
+// Defaults 250ms (tune takes max 60ms) and 15s (a full band seek takes up to 7s at 50kHz spacing)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::setTimeout(unsigned int tuneMs, unsigned int seekMs)
+{
+  _tuneTimeout = tuneMs;
+  _seekTimeout = seekMs;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Set the number of attempts for each register read/write (default 10, min 1)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::setRetries(byte tries)
+{
+  _busTries = tries ? tries : 1;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get the last error and clear it
+// Returns ERR_NONE, ERR_BUS, ERR_TIMEOUT or ERR_DEVICE
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte	Si4703T<Bus, Region>::getError(void)
+{
+  byte err = _error;
+  _error = ERR_NONE;
+  return err;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get number of bytes sent by the last register write
+// Writes are truncated after the highest changed register, so this shows the saving against the full 12 bytes
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getWriteBytes(void)
+{
+  return(_writeBytes);
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get statistics: bus traffic since the last reset, and time blocked in each blocking API
+// With reset = 1 the counters are cleared in the same step, so nothing is lost between two snapshots.
+// Returns false (and zeros) if the library was built with SI4703_STATS 0
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+bool	Si4703T<Bus, Region>::getStats(si4703Stats_t &stats, bool reset)
+{
+#if SI4703_STATS
+  noInterrupts();                                   // rdsCaptures/bytesRead are updated by the ISR
+  stats = _stats;
+  if (reset) memset(&_stats, 0, sizeof(_stats));
+  interrupts();
+  return true;
+#else
+  memset(&stats, 0, sizeof(stats));
+  return false;
+#endif
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Reset statistics
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+void	Si4703T<Bus, Region>::resetStats(void)
+{
+#if SI4703_STATS
+  noInterrupts();
+  memset(&_stats, 0, sizeof(_stats));
+  interrupts();
+#endif
+}
+#if SI4703_STATS
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Time a blocking API, only the outermost one counts (e.g. scanBand() and not the setChannel() calls it makes)
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+Si4703T<Bus, Region>::StatsBlock::StatsBlock(Si4703T &radio, uint8_t api) : _radio(radio)
+{
+  _api = STATS_API_NONE;
+  if (_radio._statsApi != STATS_API_NONE) return;   // Inside another blocking API
+  _api   = api;
+  _start = micros();
+  _radio._statsApi = api;
+}
+
+template <class Bus, class Region>
+Si4703T<Bus, Region>::StatsBlock::~StatsBlock()
+{
+  if (_api == STATS_API_NONE) return;
+  _radio._stats.blockUs[_api] += micros() - _start;
+  _radio._statsApi = STATS_API_NONE;
+}
+#endif
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get DeviceID:Part Number
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getPN()
+{
+  return(shadow.reg.DEVICEID.bits.PN);  // return cached value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get DeviceID:Manufacturer ID
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getMFGID()
+{
+  return(shadow.reg.DEVICEID.bits.MFGID);  // return cached value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get ChipID:Chip Version
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getREV()
+{
+  return(shadow.reg.CHIPID.bits.REV);  // return cached value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get ChipID:Device
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getDEV()
+{
+  return(shadow.reg.CHIPID.bits.DEV);  // return cached value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get ChipID:Firmware Version
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getFIRMWARE()
+{
+  return(shadow.reg.CHIPID.bits.FIRMWARE);  // return cached value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Band Start Frequency
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getBandStart()
+{
+  return(_region.start());
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Band End Frequency
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getBandEnd()
+{
+  return(_region.end());
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get Band Step
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int	Si4703T<Bus, Region>::getBandSpace()
+{
+  return(_region.spacing());
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get RSSI current value
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+int Si4703T<Bus, Region>::getRSSI(void)
+{
+  readStatus(1);                            // Read STATUSRSSI only (2 bytes)
+  return(shadow.reg.STATUSRSSI.bits.RSSI);  // Return RSSI value
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Get signal quality of the tuned channel for Si4703_Monitor
+// Reads STATUSRSSI and READCHAN only (4 bytes), s is only changed on success
+//-----------------------------------------------------------------------------------------------------------------------------------
+template <class Bus, class Region>
+byte Si4703T<Bus, Region>::readSignal(signal_t &s)
+{
+  byte err = readStatus(2);                 // Read STATUSRSSI and READCHAN (4 bytes)
+  if (err) return err;
+
+  s.freq  = _region.freq(shadow.reg.READCHAN.bits.READCHAN);
+  s.rssi  = shadow.reg.STATUSRSSI.bits.RSSI;
+  s.st    = shadow.reg.STATUSRSSI.bits.ST;
+  s.rdss  = shadow.reg.STATUSRSSI.bits.RDSS;
+  s.afcrl = shadow.reg.STATUSRSSI.bits.AFCRL;
+  if (_rdsStats) _rdsStats->sync(s.rdss);
+  return ERR_NONE;
+}
+
+#undef STATS_ADD
+#undef STATS_BLOCK
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ *  Host (Linux) stand-in for the Arduino core: virtual clock, pins and external interrupts.
+ */
+
+#include "Arduino.h"
+#include "host.h"
+
+namespace
+{
+	const int	PINS		= 32;
+	const int	IRQS		= 2;
+	const int	DEVICES		= 8;
+
+	uint64_t		now_us;						// Virtual time
+	int				pinLevel[PINS];				// Pin levels
+	void			(*isr[IRQS])(void);			// Attached ISRs
+	int				isrMode[IRQS];				// Edge of attached ISRs
+	bool			isrPending[IRQS];			// Edge seen, ISR not run yet
+	bool			irqEnabled;					// Global interrupt enable
+	host::Device	*device[DEVICES];			// Registered devices
+	int				devices;
+
+	int irqPin(int irq)	{ return irq == 0 ? 2 : 3; }
+
+	//------------------------------------------------------------------------------------------------------------
+	// Run pending ISRs while interrupts are enabled, like the AVR does when leaving cli()
+	//------------------------------------------------------------------------------------------------------------
+	void serviceIRQ(void)
+	{
+		for (int irq = 0; irq < IRQS && irqEnabled; irq++)
+		{
+			if (!isrPending[irq] || !isr[irq]) continue;
+			isrPending[irq] = false;
+			irqEnabled = false;					// Interrupts are disabled inside an ISR
+			isr[irq]();
+			irqEnabled = true;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Host control
+//-----------------------------------------------------------------------------------------------------------------------------------
+void host::reset(void)
+{
+	now_us = 0;
+	for (int i = 0; i < PINS; i++) pinLevel[i] = LOW;
+	for (int i = 0; i < IRQS; i++) { isr[i] = 0; isrPending[i] = false; }
+	irqEnabled = true;
+	devices = 0;
+}
+
+uint64_t host::now(void)
+{
+	return now_us;
+}
+
+void host::advance(uint64_t us)
+{
+	uint64_t target = now_us + us;
+
+	for (;;)									// Fire device events in time order
+	{
+		uint64_t next = 0;
+		host::Device *dev = 0;
+		for (int i = 0; i < devices; i++)
+		{
+			uint64_t t = device[i]->nextEvent();
+			if (t && t <= target && (!next || t < next)) { next = t; dev = device[i]; }
+		}
+		if (!dev) break;
+		if (next > now_us) now_us = next;
+		dev->fire(now_us);
+		serviceIRQ();							// ISRs may do bus transactions and move time themselves
+	}
+	if (target > now_us) now_us = target;
+	serviceIRQ();
+}
+
+void host::addDevice(host::Device *dev)
+{
+	if (devices < DEVICES) device[devices++] = dev;
+}
+
+void host::setPin(int pin, int level)
+{
+	if (pin < 0 || pin >= PINS || pinLevel[pin] == level) return;
+	pinLevel[pin] = level;
+
+	for (int irq = 0; irq < IRQS; irq++)		// Latch edge for the ISR
+	{
+		if (irqPin(irq) != pin || !isr[irq]) continue;
+		if (isrMode[irq] == CHANGE ||
+			(isrMode[irq] == FALLING && level == LOW) ||
+			(isrMode[irq] == RISING  && level == HIGH))
+			isrPending[irq] = true;
+	}
+}
+
+int host::getPin(int pin)
+{
+	if (pin < 0 || pin >= PINS) return LOW;
+	return pinLevel[pin];
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Arduino core
+//-----------------------------------------------------------------------------------------------------------------------------------
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	if (mode == INPUT_PULLUP && pin < PINS) pinLevel[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+	if (pin >= PINS) return;
+	pinLevel[pin] = val ? HIGH : LOW;
+	for (int i = 0; i < devices; i++) device[i]->pinWritten(pin, pinLevel[pin]);
+}
+
+int digitalRead(uint8_t pin)
+{
+	return host::getPin(pin);
+}
+
+unsigned long millis(void)
+{
+	return (unsigned long)(now_us / 1000);
+}
+
+unsigned long micros(void)
+{
+	return (unsigned long)now_us;
+}
+
+void delay(unsigned long ms)
+{
+	host::advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	host::advance(us);
+}
+
+void yield(void)
+{
+	host::advance(10);							// CPU time spent in a busy loop iteration
+}
+
+int digitalPinToInterrupt(uint8_t pin)
+{
+	if (pin == 2) return 0;
+	if (pin == 3) return 1;
+	return NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode)
+{
+	if (interruptNum >= IRQS) return;
+	isr[interruptNum]        = userFunc;
+	isrMode[interruptNum]    = mode;
+	isrPending[interruptNum] = false;
+}
+
+void detachInterrupt(uint8_t interruptNum)
+{
+	if (interruptNum >= IRQS) return;
+	isr[interruptNum]        = 0;
+	isrPending[interruptNum] = false;
+}
+
+void interrupts(void)
+{
+	irqEnabled = true;
+	serviceIRQ();
+}
+
+void noInterrupts(void)
+{
+	irqEnabled = false;
+}
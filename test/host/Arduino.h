@@ -0,0 +1,52 @@
+/*
+ *  Host (Linux) stand-in for the Arduino core, just enough for the Si4703 library and its tests.
+ *  Time is virtual: it only moves on delay(), yield() and bus transactions, see host.h.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef uint8_t	byte;
+typedef bool	boolean;
+
+#define HIGH				0x1
+#define LOW					0x0
+
+#define INPUT				0x0
+#define OUTPUT				0x1
+#define INPUT_PULLUP		0x2
+
+#define CHANGE				1
+#define FALLING				2
+#define RISING				3
+
+#define NOT_AN_INTERRUPT	-1
+
+#define DEC					10
+#define HEX					16
+
+#define A4					18		// I2C SDA on ATmega328
+#define A5					19		// I2C SCL on ATmega328
+
+void			pinMode(uint8_t pin, uint8_t mode);
+void			digitalWrite(uint8_t pin, uint8_t val);
+int				digitalRead(uint8_t pin);
+
+unsigned long	millis(void);
+unsigned long	micros(void);
+void			delay(unsigned long ms);
+void			delayMicroseconds(unsigned int us);
+void			yield(void);
+
+int				digitalPinToInterrupt(uint8_t pin);		// Pin 2 = 0, pin 3 = 1 (ATmega328)
+void			attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void			detachInterrupt(uint8_t interruptNum);
+void			interrupts(void);
+void			noInterrupts(void);
+
+#endif
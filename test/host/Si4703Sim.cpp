@@ -0,0 +1,557 @@
+/*
+ *  Behavioural model of the Si4703 for host tests.
+ */
+
+#include "Si4703Sim.h"
+
+namespace
+{
+	const uint16_t	DEVICEID		= 0x1242;	// PN=1, MFGID=0x242
+	const uint16_t	CHIPID_DOWN		= 0x1000;	// REV=4, DEV=0, FIRMWARE=0 before power up
+	const uint16_t	CHIPID_UP		= 0x1253;	// REV=4, DEV=9 (Si4703), FIRMWARE=0x13
+	const uint16_t	TEST1_RESET		= 0x0100;
+
+	// POWERCFG
+	const uint16_t	ENABLE			= 0x0001;
+	const uint16_t	DISABLE			= 0x0040;
+	const uint16_t	SEEK			= 0x0100;
+	const uint16_t	SEEKUP			= 0x0200;
+	const uint16_t	SKMODE			= 0x0400;
+	const uint16_t	MONO			= 0x2000;
+	// CHANNEL
+	const uint16_t	TUNE			= 0x8000;
+	// SYSCONFIG1
+	const uint16_t	RDS				= 0x1000;
+	const uint16_t	STCIEN			= 0x4000;
+	const uint16_t	RDSIEN			= 0x8000;
+	// TEST1
+	const uint16_t	XOSCEN			= 0x8000;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Setup
+//-----------------------------------------------------------------------------------------------------------------------------------
+Si4703Sim::Si4703Sim(int rstPin, int sdioPin, int gpio2Pin, int sclkPin, int senPin)
+{
+	_rstPin   = rstPin;
+	_sdioPin  = sdioPin;
+	_gpio2Pin = gpio2Pin;
+	_sclkPin  = sclkPin;
+	_senPin   = senPin;
+	reset();
+}
+
+void Si4703Sim::reset(void)
+{
+	powerUpTime     = 40000;
+	oscSettleTime   = 500000;
+	tuneTime        = 60000;
+	seekChannelTime = 30000;
+	rdsPeriod       = 87600;
+	rdsReadyTime    = 40000;
+	pulseTime       = 5000;
+
+	nack            = 0;
+	missSTC         = false;
+	rdsLost         = false;
+
+	groupsSent      = 0;
+	stcCount        = 0;
+	seekChannels    = 0;
+
+	_noise          = 8;
+	_stations.clear();
+
+	_i2c            = false;				// Bus mode is unknown until a reset
+	_3wire          = false;
+	_inReset        = false;
+	_sdioLevel      = HIGH;					// Pulled up on the breakout board
+	_senLevel       = HIGH;					// Pulled up on the breakout board
+	_bits           = 0;
+	powerOnReset();
+}
+
+void Si4703Sim::connect(TwoWire &bus)
+{
+	host::addDevice(this);
+	bus.attach(0x10, this);
+}
+
+void Si4703Sim::connectPins(void)
+{
+	host::addDevice(this);
+}
+
+void Si4703Sim::powerOnReset(void)
+{
+	for (int i = 0; i < 16; i++) _reg[i] = 0;
+	_reg[0x00] = DEVICEID;
+	_reg[0x01] = CHIPID_DOWN;
+	_reg[0x07] = TEST1_RESET;
+
+	_xoscAt   = 0;
+	_oscOk    = false;
+	_powered  = false;
+	_upAt     = 0;
+
+	_op       = OP_NONE;
+	_opDone   = 0;
+	_chan     = 0;
+	_stc      = false;
+	_sfbl     = false;
+
+	_rdsNext  = 0;
+	_rdsrEnd  = 0;
+	_rdsr     = false;
+	_rdss     = false;
+	_rdsIdx   = 0;
+	for (int i = 0; i < 4; i++) _bler[i] = 0;
+	_pulseEnd = 0;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Band
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703Sim::addStation(int freq, uint8_t rssi, bool stereo)
+{
+	Station s;
+	s.freq   = freq;
+	s.rssi   = rssi;
+	s.stereo = stereo;
+	_stations.push_back(s);
+}
+
+void Si4703Sim::addGroup(int freq, uint16_t a, uint16_t b, uint16_t c, uint16_t d,
+						 uint8_t blerA, uint8_t blerB, uint8_t blerC, uint8_t blerD)
+{
+	SimGroup g = { { a, b, c, d }, { blerA, blerB, blerC, blerD } };
+	for (size_t i = 0; i < _stations.size(); i++)
+		if (_stations[i].freq == freq) { _stations[i].groups.push_back(g); return; }
+	addStation(freq, 40);
+	_stations.back().groups.push_back(g);
+}
+
+void Si4703Sim::setStation(int freq, uint8_t rssi, bool stereo)
+{
+	for (size_t i = 0; i < _stations.size(); i++)
+		if (_stations[i].freq == freq)
+		{
+			_stations[i].rssi   = rssi;
+			_stations[i].stereo = stereo;
+			return;
+		}
+	addStation(freq, rssi, stereo);
+}
+
+void Si4703Sim::setNoise(uint8_t rssi)
+{
+	_noise = rssi;
+}
+
+int Si4703Sim::bandStart(void)
+{
+	return ((_reg[0x05] >> 6) & 0x03) == 0 ? 8750 : 7600;
+}
+
+int Si4703Sim::spacing(void)
+{
+	switch ((_reg[0x05] >> 4) & 0x03)
+	{
+		case 0:  return 20;
+		case 1:  return 10;
+		default: return 5;
+	}
+}
+
+int Si4703Sim::maxChan(void)
+{
+	int end = ((_reg[0x05] >> 6) & 0x03) == 2 ? 9000 : 10800;
+	return (end - bandStart()) / spacing();
+}
+
+Si4703Sim::Station* Si4703Sim::station(int chan)
+{
+	int f = bandStart() + chan * spacing();
+	for (size_t i = 0; i < _stations.size(); i++)
+		if (_stations[i].freq == f) return &_stations[i];
+	return 0;
+}
+
+uint8_t Si4703Sim::rssi(int chan)
+{
+	Station *s = station(chan);
+	return s ? s->rssi : _noise;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Inspection
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint16_t Si4703Sim::reg(uint8_t addr)
+{
+	updateStatus();
+	return _reg[addr & 0x0F];
+}
+
+bool Si4703Sim::isI2C(void)
+{
+	return _i2c && !_inReset;
+}
+
+bool Si4703Sim::is3Wire(void)
+{
+	return _3wire && !_inReset;
+}
+
+bool Si4703Sim::isPowered(void)
+{
+	return _powered && !_upAt;
+}
+
+int Si4703Sim::freq(void)
+{
+	return bandStart() + (reg(0x0B) & 0x3FF) * spacing();
+}
+
+bool Si4703Sim::oscSettled(void)
+{
+	return _oscOk;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Pins: RST low resets, SDIO on the rising edge of RST selects the bus mode (SEN high):
+// low = 2-wire, high = 3-wire (only if SEN is wired)
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703Sim::pinWritten(int pin, int level)
+{
+	if (pin == _sdioPin) _sdioLevel = level;
+	if (pin == _senPin)  senWritten(level);
+	if (pin == _sclkPin) sclkWritten(level);
+	if (pin != _rstPin) return;
+
+	if (level == LOW)
+	{
+		_inReset = true;
+		_i2c     = false;
+		_3wire   = false;
+		powerOnReset();
+	}
+	else if (_inReset)
+	{
+		_inReset = false;
+		_i2c     = (_sdioLevel == LOW);
+		_3wire   = (_sdioLevel == HIGH) && (_senPin >= 0) && (_senLevel == HIGH);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// 3-wire: SEN low starts a transfer of 9 control bits (A7:A5 = 011, R/W, A4:A0) and 16 data bits, latched
+// on the rising edge of SCLK. Read data is driven on SDIO after each falling edge, a write is done at SEN high.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703Sim::senWritten(int level)
+{
+	_senLevel = level;
+	if (!is3Wire()) return;
+
+	if (level == LOW)
+	{
+		_bits  = 0;
+		_shift = 0;
+		_rd    = false;
+		return;
+	}
+
+	if (_bits == 25 && !_rd && _addr >= 0x02 && _addr <= 0x09)	// 0x0A-0x0F are read only
+	{
+		uint16_t old[16];
+		memcpy(old, _reg, sizeof(old));
+		_reg[_addr] = _shift;
+		applyWrite(old);
+	}
+	_bits = 0;
+}
+
+void Si4703Sim::sclkWritten(int level)
+{
+	if (!is3Wire() || _senLevel != LOW) return;
+
+	if (level == HIGH)
+	{
+		if (_bits >= 25) return;				// Extra clocks are ignored
+		if (!_rd) _shift = (_shift << 1) | (_sdioLevel ? 1 : 0);
+		if (++_bits != 9) return;
+
+		_rd    = (_shift >> 5) & 1;
+		_addr  = (((_shift >> 6) & 0x07) == 0x03) ? (_shift & 0x1F) : 0xFF;
+		_shift = 0;
+		if (_rd)
+		{
+			updateStatus();
+			_out = (_addr <= 0x0F) ? _reg[_addr] : 0;
+		}
+	}
+	else if (_rd && _bits >= 9 && _bits < 25)
+	{
+		host::setPin(_sdioPin, (_out & 0x8000) ? HIGH : LOW);
+		_out <<= 1;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// I2C: reads start at 0x0A, writes start at 0x02
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703Sim::i2cRead(uint8_t *data, int len)
+{
+	if (!isI2C()) return 0;
+	if (nack > 0) { nack--; return 0; }
+
+	updateStatus();
+	for (int i = 0; i < len; i++)
+	{
+		uint16_t w = _reg[(0x0A + i / 2) & 0x0F];
+		data[i] = (i & 1) ? (w & 0xFF) : (w >> 8);
+	}
+	return len;
+}
+
+bool Si4703Sim::i2cWrite(const uint8_t *data, int len)
+{
+	if (!isI2C()) return false;
+	if (nack > 0) { nack--; return false; }
+
+	uint16_t old[16];
+	memcpy(old, _reg, sizeof(old));
+	for (int i = 0; i + 1 < len; i += 2)
+	{
+		uint8_t addr = 0x02 + i / 2;
+		if (addr > 0x09) break;					// 0x0A-0x0F are read only
+		_reg[addr] = (data[i] << 8) | data[i + 1];
+	}
+	applyWrite(old);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// React to written control registers
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703Sim::applyWrite(const uint16_t *old)
+{
+	// Oscillator
+	if (!(_reg[0x07] & XOSCEN))            _xoscAt = 0;
+	else if (!(old[0x07] & XOSCEN))        _xoscAt = now();
+
+	// GPIO2 output
+	if (!_pulseEnd)
+		switch ((_reg[0x04] >> 2) & 0x03)
+		{
+			case 2:  host::setPin(_gpio2Pin, LOW);  break;	// GPIO_Low
+			default: host::setPin(_gpio2Pin, HIGH); break;	// High, interrupt idle, or pulled up
+		}
+
+	// Power
+	bool en  = _reg[0x02] & ENABLE;
+	bool dis = _reg[0x02] & DISABLE;
+	if (en && dis)								// Power down
+	{
+		if (_powered)
+		{
+			uint16_t keep[16];
+			memcpy(keep, _reg, sizeof(keep));
+			bool     i2c   = _i2c;
+			uint64_t xosc  = _xoscAt;
+			powerOnReset();
+			memcpy(_reg + 0x02, keep + 0x02, 8 * sizeof(uint16_t));	// Control registers are kept
+			_i2c = i2c;
+			if (_reg[0x07] & XOSCEN) _xoscAt = xosc;	// Crystal keeps running while XOSCEN is set
+		}
+		_reg[0x02] &= ~(ENABLE | DISABLE);		// Cleared once powered down
+		return;
+	}
+	if (en && !_powered)						// Power up
+	{
+		_powered = true;
+		_upAt    = now() + powerUpTime;
+		_oscOk   = _xoscAt && (now() - _xoscAt >= oscSettleTime);
+		return;
+	}
+	if (!isPowered()) return;					// Tune/seek need a powered up device
+
+	// Tune
+	bool tune = _reg[0x03] & TUNE;
+	if (tune && !(old[0x03] & TUNE))
+	{
+		int ch = _reg[0x03] & 0x3FF;
+		if (ch > maxChan()) ch = maxChan();
+		_op       = OP_TUNE;
+		_opStart  = now();
+		_opDone   = now() + tuneTime;
+		_opEnd    = ch;
+		_opFail   = false;
+		_chan     = ch;
+		_stc      = false;
+		_sfbl     = false;
+		_rdsNext  = 0;							// No RDS while tuning
+		_rdsr     = false;
+		_rdss     = false;
+	}
+
+	// Seek
+	bool seek = _reg[0x02] & SEEK;
+	if (seek && !(old[0x02] & SEEK)) startSeek();
+
+	// TUNE/SEEK cleared: clear STC/SFBL, abort if not done
+	if ((!tune && (old[0x03] & TUNE)) || (!seek && (old[0x02] & SEEK)))
+	{
+		if (_op == OP_SEEK && _opDone) _chan = progress();
+		if (_opDone) _rdsNext = now() + rdsPeriod;
+		_op     = OP_NONE;
+		_opDone = 0;
+		_stc    = false;
+		_sfbl   = false;
+	}
+}
+
+void Si4703Sim::startSeek(void)
+{
+	int     from = _chan;
+	int     dir  = (_reg[0x02] & SEEKUP) ? 1 : -1;
+	bool    stop = _reg[0x02] & SKMODE;
+	uint8_t th   = _reg[0x05] >> 8;
+	int     maxc = maxChan();
+	int     ch   = from;
+	int     k    = 0;
+	bool    fail = false;
+
+	for (;;)
+	{
+		ch += dir;
+		k++;
+		if (ch < 0 || ch > maxc)				// Band limit
+		{
+			if (stop)
+			{
+				ch   = (ch < 0) ? 0 : maxc;
+				fail = true;
+				break;
+			}
+			ch = (ch < 0) ? maxc : 0;
+		}
+		if (ch == from) { fail = true; break; }	// Whole band without a station
+		if (rssi(ch) >= th) break;
+	}
+
+	_op           = OP_SEEK;
+	_opStart      = now();
+	_opDone       = now() + (uint64_t)k * seekChannelTime;
+	_opFrom       = from;
+	_opDir        = dir;
+	_opEnd        = ch;
+	_opSteps      = k;
+	_opFail       = fail;
+	_stc          = false;
+	_sfbl         = false;
+	_rdsNext      = 0;
+	_rdsr         = false;
+	_rdss         = false;
+	seekChannels  = k;
+}
+
+int Si4703Sim::progress(void)
+{
+	if (_op != OP_SEEK || !_opDone) return _chan;
+
+	int n = (now() - _opStart) / seekChannelTime;
+	if (n >= _opSteps) return _opEnd;
+	int m  = maxChan() + 1;
+	int ch = _opFrom + _opDir * n;
+	return ((ch % m) + m) % m;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Events
+//-----------------------------------------------------------------------------------------------------------------------------------
+uint64_t Si4703Sim::nextEvent(void)
+{
+	uint64_t t[5] = { _upAt, _opDone, _rdsNext, _rdsrEnd, _pulseEnd };
+	uint64_t next = 0;
+	for (int i = 0; i < 5; i++)
+		if (t[i] && (!next || t[i] < next)) next = t[i];
+	return next;
+}
+
+void Si4703Sim::fire(uint64_t t)
+{
+	if (_upAt && t >= _upAt)					// Powered up
+	{
+		_upAt      = 0;
+		_reg[0x01] = CHIPID_UP;
+		_rdsNext   = t + rdsPeriod;
+	}
+
+	if (_opDone && t >= _opDone) complete();
+
+	if (_rdsrEnd && t >= _rdsrEnd)
+	{
+		_rdsr    = false;
+		_rdsrEnd = 0;
+	}
+
+	if (_rdsNext && t >= _rdsNext)				// Next RDS group
+	{
+		_rdsNext += rdsPeriod;
+		Station *s = station(_chan);
+		if (rdsLost)
+			_rdss = false;
+		else if ((_reg[0x04] & RDS) && s && !s->groups.empty())
+		{
+			const SimGroup &g = s->groups[_rdsIdx++ % s->groups.size()];
+			for (int i = 0; i < 4; i++)
+			{
+				_reg[0x0C + i] = g.block[i];
+				_bler[i]       = g.bler[i];
+			}
+			_rdsr    = true;
+			_rdss    = true;
+			_rdsrEnd = t + rdsReadyTime;
+			groupsSent++;
+			if (_reg[0x04] & RDSIEN) pulse();
+		}
+	}
+
+	if (_pulseEnd && t >= _pulseEnd)
+	{
+		_pulseEnd = 0;
+		host::setPin(_gpio2Pin, HIGH);
+	}
+}
+
+void Si4703Sim::complete(void)
+{
+	_chan    = _opEnd;
+	_opDone  = 0;
+	if (missSTC) return;
+	_stc     = true;
+	_sfbl    = _opFail;
+	_rdsIdx  = 0;
+	_rdsNext = now() + rdsPeriod;
+	stcCount++;
+	if (_reg[0x04] & STCIEN) pulse();
+}
+
+void Si4703Sim::pulse(void)
+{
+	if (((_reg[0x04] >> 2) & 0x03) != 1) return;	// GPIO2 is not the STC/RDS interrupt
+	host::setPin(_gpio2Pin, LOW);
+	_pulseEnd = now() + pulseTime;
+}
+
+void Si4703Sim::updateStatus(void)
+{
+	int     ch = progress();
+	bool    up = isPowered();
+	Station *s = station(ch);
+	bool    st = up && s && s->stereo && !(_reg[0x02] & MONO) && !(_op != OP_NONE && _opDone);
+
+	_reg[0x0A] = (up ? rssi(ch) : 0) | (st << 8) | ((_bler[0] & 3) << 9) | (_rdss << 11) |
+				 (_sfbl << 13) | (_stc << 14) | (_rdsr << 15);
+	_reg[0x0B] = (ch & 0x3FF) | ((_bler[3] & 3) << 10) | ((_bler[2] & 3) << 12) | ((_bler[1] & 3) << 14);
+}
@@ -0,0 +1,161 @@
+/*
+ *  Behavioural model of the Si4703 for host tests.
+ *
+ *  - Register file 0x00-0x0F, reads start at 0x0A and wrap, writes start at 0x02
+ *  - Reset/bus mode from RST and SDIO, 2-wire (I2C) and 3-wire (SEN, SCLK, SDIO) interfaces
+ *  - Oscillator and power up timing, power down
+ *  - Tune and seek (wrap/stop, SEEKTH) with STC/SFBL timing and READCHAN progress
+ *  - A band of stations with RSSI and stereo, and RDS groups sent every 87.6ms
+ *  - GPIO2 STC/RDS interrupt pulses
+ */
+
+#ifndef Si4703Sim_h
+#define Si4703Sim_h
+
+#include <stdint.h>
+#include <vector>
+#include "Arduino.h"
+#include "Wire.h"
+#include "host.h"
+
+//------------------------------------------------------------------------------------------------------------
+// RDS group sent by a simulated station
+//------------------------------------------------------------------------------------------------------------
+struct SimGroup
+{
+	uint16_t	block[4];			// Blocks A, B, C, D
+	uint8_t		bler[4];			// Block error levels A, B, C, D
+};
+
+//------------------------------------------------------------------------------------------------------------
+
+class Si4703Sim : public I2CDevice, public host::Device
+{
+  public:
+	Si4703Sim(int rstPin = 4, int sdioPin = A4, int gpio2Pin = 3,
+			  int sclkPin = A5, int senPin = -1);		// senPin -1: SEN not wired, no 3-wire mode
+
+	void		reset(void);							// Power on state, no stations, default timing
+	void		connect(TwoWire &bus = Wire);			// Register with the clock and attach at 0x10
+	void		connectPins(void);						// Register with the clock only (3-wire, Si4703SimBus)
+
+	// Band
+	void		addStation(int freq, uint8_t rssi, bool stereo = true);	// freq like 9440 for 94.4 MHz
+	void		addGroup(int freq, uint16_t a, uint16_t b, uint16_t c, uint16_t d,
+						 uint8_t blerA = 0, uint8_t blerB = 0, uint8_t blerC = 0, uint8_t blerD = 0);
+	void		setStation(int freq, uint8_t rssi, bool stereo = true);	// Change a station (fading), add if new
+	void		setNoise(uint8_t rssi);					// RSSI of empty channels
+
+	// Inspection
+	uint16_t	reg(uint8_t addr);						// Register as the device holds it
+	bool		isI2C(void);							// In 2-wire mode
+	bool		is3Wire(void);							// In 3-wire mode
+	bool		isPowered(void);						// Powered up (ENABLE written and power up time over)
+	int			freq(void);								// Frequency of READCHAN
+	bool		oscSettled(void);						// Crystal had settled when ENABLE was written
+
+	// Timing (us)
+	uint32_t	powerUpTime;							// ENABLE to powered up
+	uint32_t	oscSettleTime;							// XOSCEN to stable crystal
+	uint32_t	tuneTime;								// TUNE to STC
+	uint32_t	seekChannelTime;						// Per channel examined by a seek
+	uint32_t	rdsPeriod;								// Between RDS groups
+	uint32_t	rdsReadyTime;							// RDSR high after a group
+	uint32_t	pulseTime;								// GPIO2 interrupt pulse
+
+	// Faults
+	int			nack;									// NACK the next n transactions
+	bool		missSTC;								// Tune/seek never set STC
+	bool		rdsLost;								// No RDS groups and RDSS off (fade, multipath)
+
+	// Counters
+	unsigned long	groupsSent;							// RDS groups made ready
+	unsigned long	stcCount;							// STC set by tune/seek
+	unsigned long	seekChannels;						// Channels examined by the last seek
+
+	// I2CDevice
+	bool		i2cWrite(const uint8_t *data, int len);
+	int			i2cRead(uint8_t *data, int len);
+
+	// host::Device
+	uint64_t	nextEvent(void);
+	void		fire(uint64_t now);
+	void		pinWritten(int pin, int level);
+
+  private:
+	struct Station
+	{
+		int						freq;
+		uint8_t					rssi;
+		bool					stereo;
+		std::vector<SimGroup>	groups;
+	};
+
+	static const uint8_t	OP_NONE		= 0;
+	static const uint8_t	OP_TUNE		= 1;
+	static const uint8_t	OP_SEEK		= 2;
+
+	int			_rstPin;
+	int			_sdioPin;
+	int			_gpio2Pin;
+	int			_sclkPin;
+	int			_senPin;
+
+	uint16_t	_reg[16];
+	bool		_i2c;							// 2-wire mode selected at reset
+	bool		_3wire;							// 3-wire mode selected at reset
+	bool		_inReset;						// RST held low
+	int			_sdioLevel;						// Last SDIO level written by the MCU
+	int			_senLevel;						// Last SEN level written by the MCU
+
+	uint8_t		_bits;							// 3-wire: SCLK rising edges since SEN low
+	uint16_t	_shift;							// 3-wire: control word, then write data
+	bool		_rd;							// 3-wire: read transfer
+	uint8_t		_addr;							// 3-wire: register, 0xFF = invalid control word
+	uint16_t	_out;							// 3-wire: read data still to send
+	uint64_t	_xoscAt;						// Time XOSCEN was set, 0 = off
+	bool		_oscOk;							// Oscillator had settled at ENABLE
+	bool		_powered;						// ENABLE written
+	uint64_t	_upAt;							// Power up done time, 0 = done
+
+	uint8_t		_op;							// Tune/seek in progress
+	uint64_t	_opStart;						// Start time
+	uint64_t	_opDone;						// STC time, 0 = STC already set
+	int			_chan;							// Current channel (READCHAN)
+	int			_opFrom;						// Seek start channel
+	int			_opDir;							// Seek direction +1/-1
+	int			_opEnd;							// Channel at STC
+	int			_opSteps;						// Channels to examine
+	bool		_opFail;						// SFBL at STC
+	bool		_stc;							// Status: Seek/Tune Complete
+	bool		_sfbl;							// Status: Seek Fail/Band Limit
+
+	uint64_t	_rdsNext;						// Next group time, 0 = none
+	uint64_t	_rdsrEnd;						// RDSR clear time, 0 = clear
+	size_t		_rdsIdx;						// Next group of the station
+	bool		_rdsr;							// Status: RDS Ready
+	bool		_rdss;							// Status: RDS Synchronized
+	uint8_t		_bler[4];						// Error levels of the current group
+	uint64_t	_pulseEnd;						// GPIO2 back high, 0 = high
+
+	uint8_t		_noise;
+	std::vector<Station>	_stations;
+
+	uint64_t	now(void)				{ return host::now(); }
+	int			bandStart(void);
+	int			spacing(void);
+	int			maxChan(void);
+	Station*	station(int chan);
+	uint8_t		rssi(int chan);
+	int			progress(void);					// Channel examined by the seek in progress
+	void		powerOnReset(void);
+	void		senWritten(int level);			// 3-wire transfer start/end
+	void		sclkWritten(int level);			// 3-wire bit
+	void		applyWrite(const uint16_t *old);
+	void		startSeek(void);
+	void		complete(void);					// Tune/seek done: STC
+	void		pulse(void);					// GPIO2 interrupt pulse
+	void		updateStatus(void);				// Refresh STATUSRSSI/READCHAN before a read
+};
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ *  Host transport for Si4703T<Bus>, straight to a Si4703Sim.
+ */
+
+#include "Si4703SimBus.h"
+
+Si4703SimBus::Si4703SimBus(Si4703Sim &sim, int sdioPin)
+{
+	_sim     = &sim;
+	_sdioPin = sdioPin;
+	reads    = 0;
+	writes   = 0;
+}
+
+void Si4703SimBus::select(int rstPin)
+{
+	pinMode(rstPin, OUTPUT);
+	pinMode(_sdioPin, OUTPUT);
+	digitalWrite(rstPin, LOW);
+	digitalWrite(_sdioPin, LOW);				// 2-wire mode
+	delay(1);
+	digitalWrite(rstPin, HIGH);
+	delay(1);
+}
+
+void Si4703SimBus::begin(void)
+{
+}
+
+bool Si4703SimBus::read(uint16_t *w, uint8_t words)
+{
+	uint8_t buf[32];
+
+	reads++;
+	int n = _sim->i2cRead(buf, words * 2);
+	host::advance((uint64_t)(n + 1) * BYTE_TIME);	// Address byte + data
+	if (n < words * 2) return false;
+
+	for (int i = 0; i < words; i++) w[i] = (buf[i * 2] << 8) | buf[i * 2 + 1];
+	return true;
+}
+
+bool Si4703SimBus::write(const uint16_t *w, uint8_t words)
+{
+	uint8_t buf[32];
+
+	writes++;
+	for (int i = 0; i < words; i++)
+	{
+		buf[i * 2]     = w[i] >> 8;
+		buf[i * 2 + 1] = w[i] & 0xFF;
+	}
+	bool ok = _sim->i2cWrite(buf, words * 2);
+	host::advance((uint64_t)((ok ? words * 2 : 0) + 1) * BYTE_TIME);	// NACK on the address byte
+	return ok;
+}
@@ -0,0 +1,34 @@
+/*
+ *  Host transport for Si4703T<Bus>: talks to a Si4703Sim directly instead of through the Wire stand-in,
+ *  so each simulated tuner can have its own bus (the Si4703 I2C address is fixed).
+ */
+
+#ifndef Si4703SimBus_h
+#define Si4703SimBus_h
+
+#include <stdint.h>
+#include "Si4703Sim.h"
+
+//------------------------------------------------------------------------------------------------------------
+
+class Si4703SimBus
+{
+  public:
+	explicit Si4703SimBus(Si4703Sim &sim, int sdioPin = A4);	// sdioPin: the simulator's SDIO pin
+
+	void		select(int rstPin);						// Reset into 2-wire mode
+	void		begin(void);
+	bool		read(uint16_t *w, uint8_t words);		// Registers 0x0A.., 100 kHz bus time
+	bool		write(const uint16_t *w, uint8_t words);	// Registers 0x02.., 100 kHz bus time
+
+	unsigned long	reads;								// Read transactions
+	unsigned long	writes;								// Write transactions
+
+  private:
+	static const uint32_t	BYTE_TIME	= 90;			// 9 bits at 100 kHz (us)
+
+	Si4703Sim	*_sim;
+	int			_sdioPin;
+};
+
+#endif
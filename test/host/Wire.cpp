@@ -0,0 +1,115 @@
+/*
+ *  Host (Linux) stand-in for the Arduino Wire library.
+ */
+
+#include "Wire.h"
+#include "host.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire()
+{
+	reset();
+}
+
+void TwoWire::reset(void)
+{
+	for (int i = 0; i < 128; i++) _dev[i] = 0;
+	_clock        = 100000;
+	_begun        = false;
+	_txLen        = 0;
+	_rxLen        = 0;
+	_rxPos        = 0;
+	writes        = 0;
+	reads         = 0;
+	bytesWritten  = 0;
+	bytesRead     = 0;
+}
+
+void TwoWire::attach(uint8_t address, I2CDevice *dev)
+{
+	_dev[address & 0x7F] = dev;
+}
+
+void TwoWire::begin(void)
+{
+	_begun = true;
+}
+
+void TwoWire::end(void)
+{
+	_begun = false;
+}
+
+void TwoWire::setClock(uint32_t clock)
+{
+	if (clock) _clock = clock;
+}
+
+uint32_t TwoWire::byteTime(void)
+{
+	return (9 * 1000000UL + _clock - 1) / _clock;	// 8 data bits + ACK
+}
+
+void TwoWire::busTime(int bytes)
+{
+	host::advance((uint64_t)(bytes + 1) * byteTime());	// Address byte + data
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+	_txAddr = address & 0x7F;
+	_txLen  = 0;
+}
+
+void TwoWire::beginTransmission(int address)
+{
+	beginTransmission((uint8_t)address);
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+	if (_txLen >= BUFFER_LEN) return 0;
+	_txBuf[_txLen++] = data;
+	return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+	(void)sendStop;
+	I2CDevice *dev = _begun ? _dev[_txAddr] : 0;
+
+	writes++;
+	if (!dev || !dev->i2cWrite(_txBuf, _txLen))
+	{
+		busTime(0);
+		return 2;									// NACK on address
+	}
+	bytesWritten += _txLen;
+	busTime(_txLen);
+	return 0;
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity)
+{
+	I2CDevice *dev = _begun ? _dev[address & 0x7F] : 0;
+
+	if (quantity > BUFFER_LEN) quantity = BUFFER_LEN;
+	reads++;
+	_rxPos = 0;
+	_rxLen = dev ? dev->i2cRead(_rxBuf, quantity) : 0;
+	bytesRead += _rxLen;
+	busTime(_rxLen);
+	return _rxLen;
+}
+
+int TwoWire::available(void)
+{
+	return _rxLen - _rxPos;
+}
+
+int TwoWire::read(void)
+{
+	if (_rxPos >= _rxLen) return -1;
+	return _rxBuf[_rxPos++];
+}
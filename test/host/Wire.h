@@ -0,0 +1,73 @@
+/*
+ *  Host (Linux) stand-in for the Arduino Wire library.
+ *  Transactions go to simulated I2C devices, and move the virtual clock by the time they take on the bus.
+ */
+
+#ifndef Wire_h
+#define Wire_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//------------------------------------------------------------------------------------------------------------
+// Simulated I2C target
+//------------------------------------------------------------------------------------------------------------
+class I2CDevice
+{
+  public:
+	virtual			~I2CDevice() {}
+	virtual bool	i2cWrite(const uint8_t *data, int len) = 0;	// Master write, false = NACK
+	virtual int		i2cRead(uint8_t *data, int len) = 0;		// Master read, returns bytes sent (0 = NACK)
+};
+
+//------------------------------------------------------------------------------------------------------------
+
+class TwoWire
+{
+  public:
+	TwoWire();
+
+	void		begin(void);
+	void		end(void);
+	void		setClock(uint32_t clock);
+
+	void		beginTransmission(uint8_t address);
+	void		beginTransmission(int address);
+	size_t		write(uint8_t data);
+	uint8_t		endTransmission(bool sendStop = true);
+
+	uint8_t		requestFrom(int address, int quantity);
+	int			available(void);
+	int			read(void);
+
+	// Host only
+	void		attach(uint8_t address, I2CDevice *dev);	// Connect a device
+	void		reset(void);								// Remove devices, clear statistics
+	uint32_t	byteTime(void);								// Time of one byte on the bus (us)
+
+	unsigned long	writes;				// Write transactions
+	unsigned long	reads;				// Read transactions
+	unsigned long	bytesWritten;		// Data bytes written
+	unsigned long	bytesRead;			// Data bytes read
+
+  private:
+	static const int	BUFFER_LEN	= 32;	// Same as the AVR Wire buffer
+
+	I2CDevice	*_dev[128];
+	uint32_t	_clock;
+	bool		_begun;
+
+	uint8_t		_txAddr;
+	uint8_t		_txBuf[BUFFER_LEN];
+	int			_txLen;
+
+	uint8_t		_rxBuf[BUFFER_LEN];
+	int			_rxLen;
+	int			_rxPos;
+
+	void		busTime(int bytes);
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ *  Host only control of the Arduino stand-in: virtual clock, pins and simulated devices.
+ */
+
+#ifndef host_h
+#define host_h
+
+#include <stdint.h>
+
+namespace host
+{
+	//------------------------------------------------------------------------------------------------------------
+	// Simulated device driven by the virtual clock and by MCU pin writes
+	//------------------------------------------------------------------------------------------------------------
+	class Device
+	{
+	  public:
+		virtual				~Device() {}
+		virtual uint64_t	nextEvent(void) = 0;				// Time (us) of next internal event, 0 = none
+		virtual void		fire(uint64_t now) = 0;				// Process all events due at now
+		virtual void		pinWritten(int pin, int level) {}	// MCU wrote an output pin
+	};
+
+	void		reset(void);						// Time 0, all pins low, no ISRs, no devices
+	uint64_t	now(void);							// Virtual time (us)
+	void		advance(uint64_t us);				// Move time forward, firing device events and ISRs on the way
+	void		addDevice(Device *dev);				// Register a device
+
+	void		setPin(int pin, int level);			// Device drives an MCU input pin (may trigger an ISR)
+	int			getPin(int pin);					// Current pin level
+}
+
+#endif
@@ -0,0 +1,11 @@
+/*
+ *  Explicit instantiation of Si4703 (Si4703T<Si4703_Wire>) and of fixed regions, so all of the template
+ *  is compiled, also the parts no test calls, with and without SI4703_STATS. The other transports are
+ *  covered by test_Si4703_Bus (the pin constructor only exists for Si4703_Wire).
+ */
+
+#include "Si4703.h"
+
+template class Si4703T<Si4703_Wire>;
+template class Si4703T<Si4703_Wire, Si4703_Region<BAND_US_EU, SPACE_200KHz, DE_75us> >;
+template class Si4703T<Si4703_Wire, Si4703_Region<BAND_JP, SPACE_50KHz, DE_50us> >;
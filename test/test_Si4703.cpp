@@ -0,0 +1,1368 @@
+/*
+ *  Si4703 driver tests against the simulated Si4703
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703.h"
+
+static Si4703Sim sim;					// RST pin 4, SDIO A4, GPIO2 on pin 3
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture
+//------------------------------------------------------------------------------------------------------------
+static void setup(void)
+{
+	host::reset();
+	Wire.reset();
+	sim.reset();
+	sim.connect();
+}
+
+static void band(void)					// Three stations, US/EU band
+{
+	sim.addStation(8810, 40);
+	sim.addStation(9440, 50, false);
+	sim.addStation(10110, 35);
+}
+
+static void psGroups(int freq, uint16_t pi, const char *ps)
+{
+	for (int seg = 0; seg < 4; seg++)
+		sim.addGroup(freq, pi, 0x0000 | seg, 0xE0CD, (ps[seg * 2] << 8) | ps[seg * 2 + 1]);
+}
+
+static int		doneFreq;
+static bool		doneSFBL;
+static int		doneCalls;
+
+static void done(int freq, bool sfbl)
+{
+	doneFreq = freq;
+	doneSFBL = sfbl;
+	doneCalls++;
+}
+
+static void wait(Si4703 &radio)
+{
+	while (radio.poll()) yield();
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Power
+//------------------------------------------------------------------------------------------------------------
+TEST(start_powers_up_in_2wire_mode)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	CHECK(sim.isI2C());
+	CHECK(sim.isPowered());
+	CHECK(sim.oscSettled());
+	CHECK(sim.reg(0x04) & 0x1000);							// RDS enabled
+	CHECK_EQ((sim.reg(0x05) >> 4) & 0x03, SPACE_100KHz);
+	CHECK_EQ((sim.reg(0x05) >> 8), 24);						// SEEKTH
+	CHECK(millis() >= 540 && millis() < 560);				// Reset + 500ms crystal + 40ms power up
+}
+
+TEST(device_ids)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	CHECK_EQ(radio.getPN(), 0x1);
+	CHECK_EQ(radio.getMFGID(), 0x242);
+	CHECK_EQ(radio.getREV(), 0x04);
+	CHECK_EQ(radio.getDEV(), 0x9);
+	CHECK_EQ(radio.getFIRMWARE(), 0x13);
+}
+
+TEST(setOscillator_external_clock)
+{
+	setup();
+	Si4703 radio;
+	radio.setOscillator(false, 0);
+	radio.start();
+
+	CHECK(sim.isPowered());
+	CHECK(!(sim.reg(0x07) & 0x8000));						// XOSCEN not set
+	CHECK(millis() < 60);
+}
+
+TEST(setOscillator_short_settle_is_seen)
+{
+	setup();
+	Si4703 radio;
+	radio.setOscillator(true, 100);
+	radio.start();
+
+	CHECK(sim.isPowered());
+	CHECK(!sim.oscSettled());								// ENABLE came before the crystal was stable
+}
+
+TEST(powerDown_and_powerUp)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.powerDown();
+
+	CHECK(!sim.isPowered());
+	CHECK(sim.reg(0x07) & 0x4000);							// AHIZEN
+
+	radio.powerUp();
+	CHECK(sim.isPowered());
+}
+
+TEST(sleep_resume_keeps_state)
+{
+	setup();
+	band();
+	Si4703 radio;
+	unsigned long t = micros();
+	radio.start();
+	radio.setChannel(9440);
+	unsigned long cold = micros() - t;
+	radio.setVolume(7);
+	radio.setMono(true);
+	radio.writeGPIO(GPIO1, GPIO_High);
+
+	CHECK_EQ(radio.sleep(), Si4703::ERR_NONE);
+	CHECK(radio.isAsleep());
+	CHECK(!sim.isPowered());
+	CHECK(sim.reg(0x07) & 0x4000);							// AHIZEN
+
+	unsigned long writes = Wire.writes;
+	radio.setVolume(9);										// Kept for resume()
+	CHECK_EQ(Wire.writes, writes);
+
+	t = micros();
+	CHECK_EQ(radio.resume(), Si4703::ERR_NONE);
+	unsigned long warm = micros() - t;
+	CHECK(!radio.isAsleep());
+	CHECK(sim.isPowered());
+	CHECK(sim.oscSettled());								// No settle time needed
+	CHECK_EQ(Wire.writes - writes, 3);						// State, tune and TUNE clear
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 9);
+	CHECK(sim.reg(0x02) & 0x2000);							// MONO
+	CHECK_EQ(sim.reg(0x04) & 0x03, GPIO_High);
+	CHECK(!(sim.reg(0x07) & 0x4000));
+	CHECK(warm * 4 < cold);
+}
+
+TEST(idle_timeout)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	radio.setIdleTimeout(1000);
+
+	Si4703_Monitor mon;
+	for (int i = 0; i < 90; i++) { radio.poll(); delay(10); }
+	CHECK(!radio.isAsleep());
+	radio.setVolume(3);										// Restarts the timeout
+	for (int i = 0; i < 90; i++) { radio.poll(); delay(10); }
+	CHECK(!radio.isAsleep());
+	for (int i = 0; i < 20; i++) { radio.poll(); delay(10); }
+	CHECK(radio.isAsleep());
+	CHECK(!sim.isPowered());
+	CHECK(!mon.poll(radio));								// Not sampled while asleep
+
+	CHECK_EQ(radio.seekUp(), 10110);						// Resumes on 94.4 first
+	CHECK(!radio.isAsleep());
+	CHECK_EQ(radio.getVolume(), 3);
+}
+
+// Check byte of an edited saveState() blob
+static void stateSum(uint8_t *buf)
+{
+	uint8_t sum = 0;
+	for (int i = 0; i < Si4703::STATE_SIZE - 1; i++)
+		sum += buf[i];
+	buf[Si4703::STATE_SIZE - 1] = ~sum;
+}
+
+TEST(saveState_restoreState)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	radio.setVolume(7);
+	radio.setMono(true);
+	uint8_t profile[Si4703::STATE_SIZE];
+	CHECK_EQ(radio.saveState(profile), Si4703::ERR_NONE);
+
+	radio.setChannel(10110);
+	radio.setVolume(2);
+	radio.setMono(false);
+	unsigned long writes = Wire.writes;
+	unsigned long tunes  = sim.stcCount;
+	CHECK_EQ(radio.restoreState(profile), Si4703::ERR_NONE);
+	CHECK_EQ(Wire.writes - writes, 2);						// Profile with TUNE, TUNE clear
+	CHECK_EQ(sim.stcCount - tunes, 1);
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK_EQ(radio.getChannel(), 9440);
+	CHECK_EQ(radio.getVolume(), 7);
+	CHECK(sim.reg(0x02) & 0x2000);							// MONO
+
+	radio.setVolume(1);
+	writes = Wire.writes;
+	CHECK_EQ(radio.restoreState(profile), Si4703::ERR_NONE);
+	CHECK_EQ(Wire.writes - writes, 1);						// Same channel: no tune
+	CHECK_EQ(sim.stcCount - tunes, 1);
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 7);
+
+	radio.setChannel(10110);
+	radio.sleep();
+	writes = Wire.writes;
+	CHECK_EQ(radio.restoreState(profile), Si4703::ERR_NONE);
+	CHECK_EQ(Wire.writes, writes);							// Kept for resume()
+	CHECK(radio.isAsleep());
+	CHECK_EQ(radio.resume(), Si4703::ERR_NONE);
+	CHECK_EQ(sim.freq(), 9440);
+}
+
+TEST(restoreState_fields_without_setter)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	uint8_t profile[Si4703::STATE_SIZE];
+	radio.saveState(profile);
+
+	profile[9] = (profile[9] & ~0x30) | (SMA_10dB << 4);		// SYSCONFIG3 SMUTEA
+	profile[6] = (profile[6] & ~0xC0) | (BLA_19_37 << 6);		// SYSCONFIG1 BLNDADJ
+	profile[5] |= 0x80;											// SYSCONFIG1 RDSIEN: not taken
+	stateSum(profile);
+	CHECK_EQ(radio.restoreState(profile), Si4703::ERR_NONE);
+	CHECK_EQ((sim.reg(0x06) >> 12) & 0x3, SMA_10dB);
+	CHECK_EQ((sim.reg(0x04) >> 6) & 0x3, BLA_19_37);
+	CHECK(!(sim.reg(0x04) & 0x8000));
+	CHECK(sim.reg(0x02) & 0x0001);							// Still enabled
+}
+
+TEST(restoreState_rejects_invalid)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	uint8_t profile[Si4703::STATE_SIZE];
+	radio.saveState(profile);
+	radio.setVolume(4);
+
+	unsigned long bytes = Wire.bytesRead + Wire.bytesWritten;
+	profile[11] ^= 0x01;										// Damaged
+	CHECK_EQ(radio.restoreState(profile), Si4703::ERR_STATE);
+	profile[0] = Si4703::STATE_VERSION + 1;						// Another version
+	stateSum(profile);
+	CHECK_EQ(radio.restoreState(profile), Si4703::ERR_STATE);
+	CHECK_EQ(radio.getError(), Si4703::ERR_STATE);
+	CHECK_EQ(Wire.bytesRead + Wire.bytesWritten, bytes);		// Nothing changed
+	CHECK_EQ(radio.getVolume(), 4);
+}
+
+TEST(warmStart_adopts_running_device)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	radio.setVolume(7);
+
+	Si4703 after;											// MCU reset
+	unsigned long t = millis();
+	CHECK(after.warmStart());
+	CHECK(millis() - t < 5);
+	CHECK_EQ(after.getChannel(), 9440);
+	CHECK_EQ(after.getVolume(), 7);
+	CHECK_EQ(after.getDEV(), 0x9);
+}
+
+TEST(warmStart_cold_starts_unknown_device)
+{
+	setup();
+	Si4703 radio;
+
+	CHECK(!radio.warmStart());
+	CHECK(sim.isPowered());
+	CHECK(sim.isI2C());
+}
+
+TEST(warmStart_cold_starts_other_region)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	Si4703 other(4, A4, A5, 0, BAND_US_EU, SPACE_200KHz);
+	CHECK(!other.warmStart());
+	CHECK_EQ((sim.reg(0x05) >> 4) & 0x03, SPACE_200KHz);
+}
+
+TEST(warmStart_clears_tune_in_progress)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.beginTune(9440);									// MCU reset before poll()
+
+	Si4703 after;
+	CHECK(after.warmStart());
+	CHECK(!(sim.reg(0x03) & 0x8000));						// TUNE cleared
+	CHECK(!(sim.reg(0x0A) & 0x4000));						// STC cleared
+}
+
+TEST(warmStart_interrupt_without_isr)
+{
+	setup();
+	band();
+	{
+		Si4703 radio(4, A4, A5, 3);
+		radio.start();
+		radio.setChannel(9440);
+		CHECK(radio.setInterrupt(true));
+	}														// Device keeps STCIEN
+
+	Si4703 after;											// intPin 0 has no interrupt
+	CHECK(after.warmStart());
+	CHECK(!(sim.reg(0x04) & 0xC000));						// STCIEN and RDSIEN cleared
+	CHECK_EQ((sim.reg(0x04) >> 2) & 0x03, GPIO_Z);
+	CHECK_EQ(after.setChannel(10110), 10110);				// Polled STC
+	CHECK_EQ(after.getError(), Si4703::ERR_NONE);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Band and tuning
+//------------------------------------------------------------------------------------------------------------
+TEST(band_limits)
+{
+	setup();
+	Si4703 us;
+	us.start();
+	CHECK_EQ(us.getBandStart(), 8750);
+	CHECK_EQ(us.getBandEnd(), 10800);
+	CHECK_EQ(us.getBandSpace(), 10);
+
+	setup();
+	Si4703 jp(4, A4, A5, 0, BAND_JP, SPACE_50KHz, DE_50us);
+	jp.start();
+	CHECK_EQ(jp.getBandStart(), 7600);
+	CHECK_EQ(jp.getBandEnd(), 9000);
+	CHECK_EQ(jp.getBandSpace(), 5);
+}
+
+TEST(setChannel_getChannel)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	CHECK_EQ(radio.setChannel(9440), 9440);
+	CHECK_EQ(radio.getChannel(), 9440);
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK(!(sim.reg(0x03) & 0x8000));						// TUNE cleared
+	CHECK(!(sim.reg(0x0A) & 0x4000));						// STC cleared
+
+	CHECK_EQ(radio.setChannel(12000), 10800);				// Clamped to band
+	CHECK_EQ(radio.setChannel(100), 8750);
+}
+
+TEST(incChannel_decChannel)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+
+	CHECK_EQ(radio.incChannel(), 9450);
+	CHECK_EQ(radio.decChannel(), 9440);
+	CHECK_EQ(radio.decChannel(), 9430);
+}
+
+TEST(getRSSI_getST)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+
+	radio.setChannel(8810);
+	CHECK_EQ(radio.getRSSI(), 40);
+	CHECK(radio.getST());
+
+	radio.setChannel(9440);
+	CHECK_EQ(radio.getRSSI(), 50);
+	CHECK(!radio.getST());									// Mono station
+
+	radio.setChannel(9000);
+	CHECK_EQ(radio.getRSSI(), 8);							// Noise
+}
+
+TEST(seekUp_seekDown)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8750);
+
+	CHECK_EQ(radio.seekUp(), 8810);
+	CHECK_EQ(radio.seekUp(), 9440);
+	CHECK_EQ(radio.seekUp(), 10110);
+	CHECK_EQ(radio.seekUp(), 0);							// SKMODE_STOP: band limit
+	CHECK_EQ(radio.getChannel(), 10800);
+	CHECK_EQ(radio.seekDown(), 10110);
+	CHECK_EQ(radio.seekDown(), 9440);
+}
+
+TEST(seek_wraps)
+{
+	setup();
+	band();
+	Si4703 radio(4, A4, A5, 0, BAND_US_EU, SPACE_100KHz, DE_75us, SKMODE_WRAP);
+	radio.start();
+	radio.setChannel(10110);
+
+	CHECK_EQ(radio.seekUp(), 8810);
+}
+
+TEST(beginTune_poll_isBusy)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	doneCalls = 0;
+
+	CHECK(!radio.poll());									// Idle
+	CHECK(!radio.isBusy());
+	CHECK(radio.beginTune(9440, done));
+	CHECK(radio.isBusy());
+	CHECK(!radio.beginTune(9000));							// Busy
+	CHECK(!radio.beginSeek(Si4703::SEEK_UP));
+
+	wait(radio);
+	CHECK(!radio.isBusy());
+	CHECK_EQ(doneCalls, 1);
+	CHECK_EQ(doneFreq, 9440);
+	CHECK(!doneSFBL);
+}
+
+TEST(tunePreset)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+
+	uint16_t preset = radio.getPresetWord(9440);
+	CHECK_EQ(preset, (9440 - 8750) / 10);
+	CHECK_EQ(radio.getPresetWord(12000), radio.getPresetWord(10800));	// Clamped to band
+
+	si4703Stats_t st;
+	radio.resetStats();
+	unsigned long reads = Wire.reads;
+	CHECK_EQ(radio.tunePreset(preset), 9440);
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK(!(sim.reg(0x03) & 0x8000));						// TUNE cleared
+	CHECK(!(sim.reg(0x0A) & 0x4000));						// STC cleared with it
+	radio.getStats(st, true);
+	CHECK_EQ(Wire.reads - reads, st.stcPolls);				// STC polls only
+
+	reads = Wire.reads;
+	CHECK_EQ(radio.tunePreset(radio.getPresetWord(8810), true), 8810);
+	radio.getStats(st, true);
+	CHECK_EQ(Wire.reads - reads, st.stcPolls + 1);			// STC clear read back
+	CHECK_EQ(radio.getRSSI(), 40);
+
+	station_t s;
+	CHECK(radio.getTuned(s));
+	CHECK_EQ(s.freq, 8810);
+}
+
+TEST(tunePreset_latency)
+{
+	setup();
+	band();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setInterrupt(true);
+	uint16_t preset = radio.getPresetWord(10110);
+
+	radio.setChannel(8810);
+	unsigned long t = micros();
+	radio.setChannel(10110);
+	unsigned long tune = micros() - t;
+
+	radio.setChannel(8810);
+	t = micros();
+	CHECK_EQ(radio.tunePreset(preset), 10110);
+	unsigned long fast = micros() - t;
+
+	CHECK(fast + 3 * 90 <= tune);							// No STC clear read
+	CHECK(fast < 60000UL + 1000);							// Tune time + under 1 ms on the bus
+}
+
+TEST(beginSeek_polls_once_per_channel)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8750);
+	doneCalls = 0;
+
+	unsigned long reads = Wire.reads;
+	unsigned long t     = millis();
+	CHECK(radio.beginSeek(Si4703::SEEK_UP, done));
+	wait(radio);
+	CHECK_EQ(doneCalls, 1);
+	CHECK_EQ(doneFreq, 8810);
+	CHECK(!doneSFBL);
+	CHECK_EQ(Wire.reads - reads, 6 + 1);					// One status read per channel, then STC clear
+	CHECK(millis() - t <= 6 * 30 + 5);
+
+	CHECK(radio.beginSeek(Si4703::SEEK_UP, done));
+	wait(radio);
+	CHECK(radio.beginSeek(Si4703::SEEK_UP, done));
+	wait(radio);
+	CHECK(radio.beginSeek(Si4703::SEEK_UP, done));
+	wait(radio);
+	CHECK(doneSFBL);										// Band limit
+	CHECK_EQ(doneFreq, 10800);
+}
+
+static int		progressFreq[64];
+static int		progressCalls;
+static int		abortAt;
+
+static bool progress(int freq)
+{
+	if (progressCalls < 64) progressFreq[progressCalls] = freq;
+	progressCalls++;
+	return !abortAt || freq < abortAt;
+}
+
+TEST(seek_progress)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8810);
+	radio.setSeekProgress(progress);
+	progressCalls = 0;
+	abortAt       = 0;
+
+	unsigned long bytes = Wire.bytesRead;
+	CHECK_EQ(radio.seekUp(), 9440);							// 63 channels, 1.9 s
+	CHECK(progressCalls >= 40);
+	CHECK_EQ(Wire.bytesRead - bytes, (unsigned long)(progressCalls + 2) * 4);	// 4 bytes per poll
+	CHECK(progressFreq[0] > 8810);
+	for (int i = 1; i < progressCalls && i < 64; i++)
+		CHECK(progressFreq[i] >= progressFreq[i - 1]);
+	CHECK(progressFreq[progressCalls - 1] < 9440);
+	CHECK_EQ(radio.getSeekProgress(), 9440);				// The poll that saw STC
+
+	radio.setSeekProgress(NULL);
+	progressCalls = 0;
+	CHECK_EQ(radio.seekDown(), 8810);
+	CHECK_EQ(progressCalls, 0);
+}
+
+TEST(seek_progress_abort)
+{
+	setup();
+	band();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setInterrupt(true);								// Progress reads also with the interrupt
+	radio.setChannel(8810);
+	radio.setSeekProgress(progress);
+	progressCalls = 0;
+	abortAt       = 9000;
+	doneCalls     = 0;
+
+	unsigned long t = millis();
+	CHECK(radio.beginSeek(Si4703::SEEK_UP, done));
+	wait(radio);
+	CHECK(millis() - t < 1000);								// Stopped early
+	CHECK_EQ(doneCalls, 1);
+	CHECK(doneSFBL);										// Reported as failed
+	CHECK(doneFreq >= 9000 && doneFreq < 9100);				// On the channel examined
+	CHECK_EQ(radio.getChannel(), doneFreq);
+	CHECK(!(sim.reg(0x02) & 0x0100));						// SEEK cleared
+	CHECK(!radio.isBusy());
+
+	abortAt = 9300;
+	CHECK_EQ(radio.seekUp(), 0);
+	CHECK(radio.getChannel() >= 9300 && radio.getChannel() < 9440);
+}
+
+TEST(seek_progress_interrupt_polls_once_per_channel)
+{
+	setup();
+	band();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setInterrupt(true);
+	radio.setChannel(8810);
+	radio.setSeekProgress(progress);
+	progressCalls = 0;
+	abortAt       = 0;
+
+	si4703Stats_t stats;
+	radio.resetStats();
+	unsigned long bytes = Wire.bytesRead;
+	CHECK_EQ(radio.seekUp(), 9440);							// 63 channels
+	radio.getStats(stats);
+	CHECK(progressCalls >= 40 && progressCalls <= 64);
+	CHECK_EQ(stats.stcPolls, (uint32_t)progressCalls + 1);	// The last one saw STC
+	CHECK(Wire.bytesRead - bytes <= (unsigned long)(progressCalls + 2) * 4);
+}
+
+TEST(cancel)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8750);
+	doneCalls = 0;
+
+	radio.beginSeek(Si4703::SEEK_UP, done);					// No station: runs to the band end
+	delay(200);
+	radio.poll();
+	radio.cancel();
+
+	CHECK(!radio.isBusy());
+	CHECK(!radio.poll());
+	CHECK_EQ(doneCalls, 0);
+	CHECK(!(sim.reg(0x02) & 0x0100));						// SEEK cleared
+	CHECK(radio.getChannel() > 8750 && radio.getChannel() < 10800);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Interrupts
+//------------------------------------------------------------------------------------------------------------
+TEST(setInterrupt)
+{
+	setup();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+
+	CHECK(radio.setInterrupt(true));
+	CHECK(sim.reg(0x04) & 0x4000);							// STCIEN
+	CHECK_EQ((sim.reg(0x04) >> 2) & 0x03, GPIO_I);
+
+	unsigned long reads = Wire.reads;
+	CHECK_EQ(radio.setChannel(9440), 9440);
+	CHECK(Wire.reads - reads <= 2);							// STC confirm and STC clear only
+
+	CHECK(radio.setInterrupt(false));
+	CHECK(!(sim.reg(0x04) & 0x4000));
+	CHECK_EQ(radio.setChannel(9000), 9000);					// Polling again
+
+	Si4703 noIrq;											// Pin 0 has no interrupt
+	CHECK(!noIrq.setInterrupt(true));
+}
+
+TEST(setInterrupt_one_instance_per_type)
+{
+	setup();
+	band();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	CHECK(radio.setInterrupt(true));
+
+	Si4703 other(4, A4, A5, 3);
+	CHECK(!other.setInterrupt(true));						// Taken
+	CHECK(!other.setRDSInterrupt(true));
+	unsigned long reads = Wire.reads;
+	CHECK_EQ(radio.setChannel(9440), 9440);					// Still served
+	CHECK(Wire.reads - reads <= 2);
+
+	CHECK(radio.setInterrupt(false));
+	CHECK(other.setInterrupt(true));						// Free again
+	CHECK(other.setInterrupt(false));
+	{
+		Si4703 scoped(4, A4, A5, 3);
+		CHECK(scoped.setInterrupt(true));
+	}
+	CHECK(radio.setInterrupt(true));						// Released by the destructor
+}
+
+TEST(start_releases_interrupt)
+{
+	setup();
+	band();
+	psGroups(9440, 0x1234, "TESTFM  ");
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+	CHECK(radio.setRDSInterrupt(true));
+	delay(500);
+	CHECK(radio.getGroupCount() > 0);
+
+	CHECK_EQ(radio.start(), Si4703::ERR_NONE);
+	CHECK_EQ(radio.getGroupCount(), 0);						// Queue dropped
+	Si4703 other(4, A4, A5, 3);
+	CHECK(other.setInterrupt(true));						// Free again
+}
+
+TEST(setInterrupt_disable_without_isr)
+{
+	setup();
+	band();
+	Si4703 radio;											// intPin 0 has no interrupt
+	radio.start();
+
+	unsigned long writes = Wire.writes;
+	CHECK(!radio.setInterrupt(true));
+	CHECK(!radio.setRDSInterrupt(true));
+	CHECK_EQ(Wire.writes, writes);							// Refused, nothing written
+
+	CHECK(radio.setInterrupt(false));
+	CHECK(radio.setRDSInterrupt(false));
+	CHECK_EQ(Wire.writes - writes, 2);						// SYSCONFIG1 written
+	CHECK(!(sim.reg(0x04) & 0xC000));
+	CHECK_EQ((sim.reg(0x04) >> 2) & 0x03, GPIO_Z);
+}
+
+TEST(setRDSInterrupt_readGroup_getGroupCount)
+{
+	setup();
+	psGroups(9440, 0x1234, "TESTFM  ");
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+
+	CHECK(radio.setRDSInterrupt(true));
+	CHECK(sim.reg(0x04) & 0x8000);							// RDSIEN
+	delay(500);
+	CHECK(radio.getGroupCount() >= 4);
+
+	rdsGroup_t g;
+	CHECK(radio.readGroup(g));
+	CHECK_EQ(g.block[0], 0x1234);
+	CHECK_EQ(g.bler[1], BLER_NONE);
+
+	while (radio.readRDS()) ;								// Decode the rest from the queue
+	CHECK_EQ(radio.getGroupCount(), 0);
+	CHECK(!radio.readGroup(g));
+	CHECK_EQ(radio.rds.getPI(), 0x1234);
+}
+
+TEST(getRDSOverflow)
+{
+	setup();
+	psGroups(9440, 0x1234, "TESTFM  ");
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+	radio.setRDSInterrupt(true);
+
+	unsigned long sent = sim.groupsSent;
+	delay(2000);											// ~22 groups, nobody reads them
+	CHECK_EQ(radio.getGroupCount(), SI4703_RDS_QUEUE_LEN);
+	CHECK_EQ(radio.getRDSOverflow(), sim.groupsSent - sent - SI4703_RDS_QUEUE_LEN);
+}
+
+TEST(rds_capture_while_bus_busy)
+{
+	setup();
+	psGroups(9440, 0x1234, "TESTFM  ");
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+	radio.setRDSInterrupt(true);
+
+	unsigned long sent = sim.groupsSent;
+	for (int i = 0; i < 300; i++) radio.getRSSI();			// Bus busy most of the time
+	CHECK_EQ(radio.getGroupCount() + radio.getRDSOverflow(), sim.groupsSent - sent);
+}
+
+TEST(rds_capture_dropped_on_tune)
+{
+	setup();
+	band();
+	psGroups(9440, 0x1234, "TESTFM  ");
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+	radio.setRDSInterrupt(true);
+	delay(500);
+	CHECK(radio.getGroupCount() >= 4);						// Nobody read them yet
+
+	radio.setChannel(10110);								// No RDS
+	CHECK_EQ(radio.getGroupCount(), 0);
+	for (int i = 0; i < 50; i++)
+	{
+		radio.readRDS();
+		delay(20);
+	}
+	CHECK_EQ(radio.rds.getPI(), 0);
+
+	radio.setChannel(9440);									// Seek too
+	delay(500);
+	CHECK_EQ(radio.seekUp(), 10110);
+	radio.readRDS();
+	CHECK_EQ(radio.rds.getPI(), 0);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// RDS
+//------------------------------------------------------------------------------------------------------------
+TEST(readRDS_polled)
+{
+	setup();
+	psGroups(9440, 0xC201, "RADIO 1 ");
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+
+	int accepted = 0;
+	for (int i = 0; i < 100; i++)							// 2 seconds
+	{
+		if (radio.readRDS()) accepted++;
+		delay(20);
+	}
+	if (radio.readRDS()) accepted++;						// Group of the last 20ms
+	CHECK_EQ(radio.rds.getPI(), 0xC201);
+	CHECK(radio.rds.hasPS());
+	CHECK(strcmp(radio.rds.getPS(), "RADIO 1 ") == 0);
+	CHECK_EQ(accepted, (int)sim.groupsSent);				// Every group once, no duplicates
+}
+
+TEST(readRDS_reset_on_tune)
+{
+	setup();
+	psGroups(9440, 0xC201, "RADIO 1 ");
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	for (int i = 0; i < 50; i++) { radio.readRDS(); delay(20); }
+	CHECK_EQ(radio.rds.getPI(), 0xC201);
+
+	radio.setChannel(9000);
+	CHECK_EQ(radio.rds.getPI(), 0);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Scan
+//------------------------------------------------------------------------------------------------------------
+TEST(scanBand_seek)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9000);
+	radio.setMute(true);
+
+	station_t list[10];
+	int n = radio.scanBand(list, 10);
+	CHECK_EQ(n, 3);
+	CHECK_EQ(list[0].freq, 8810);
+	CHECK_EQ(list[0].rssi, 40);
+	CHECK(list[0].st);
+	CHECK_EQ(list[1].freq, 9440);
+	CHECK(!list[1].st);
+	CHECK_EQ(list[2].freq, 10110);
+	CHECK(radio.getScanTime() > 0);
+	CHECK_EQ(radio.getChannel(), 9000);						// Back on the original channel
+	CHECK(radio.getMute());									// Mute restored
+	CHECK(sim.reg(0x02) & 0x4000);
+
+	CHECK_EQ(radio.scanBand(list, 2), 2);					// List size limits
+}
+
+TEST(scanBand_step_keeps_peaks)
+{
+	setup();
+	band();
+	sim.addStation(8800, 30);								// Shoulder of 88.1
+	sim.addStation(8820, 28);
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9000);
+
+	station_t list[10];
+	int n = radio.scanBand(list, 10, SCAN_STEP);
+	CHECK_EQ(n, 3);
+	CHECK_EQ(list[0].freq, 8810);
+	CHECK_EQ(list[1].freq, 9440);
+	CHECK_EQ(list[2].freq, 10110);
+	CHECK_EQ(radio.getChannel(), 9000);
+}
+
+TEST(scanBand_piWait)
+{
+	setup();
+	band();
+	psGroups(9440, 0xC201, "RADIO 1 ");
+	Si4703 radio;
+	radio.start();
+
+	station_t list[10];
+	int n = radio.scanBand(list, 10, SCAN_SEEK, 500);
+	CHECK_EQ(n, 3);
+	CHECK_EQ(list[0].pi, 0);
+	CHECK_EQ(list[1].pi, 0xC201);
+}
+
+TEST(scanBand_piWait_rds_interrupt)
+{
+	setup();
+	band();
+	psGroups(10110, 0xC201, "RADIO 1 ");
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(10110);
+	radio.setRDSInterrupt(true);
+	delay(600);												// Groups of 101.1 queued
+
+	station_t list[10];
+	int n = radio.scanBand(list, 10, SCAN_SEEK, 500);
+	CHECK_EQ(n, 3);
+	CHECK_EQ(list[0].pi, 0);								// Not the PI of 101.1
+	CHECK_EQ(list[1].pi, 0);
+	CHECK_EQ(list[2].pi, 0xC201);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Audio and GPIO
+//------------------------------------------------------------------------------------------------------------
+TEST(volume)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	CHECK_EQ(radio.setVolume(5), 5);
+	CHECK_EQ(radio.getVolume(), 5);
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 5);
+	CHECK_EQ(radio.setVolume(20), 15);
+	CHECK_EQ(radio.setVolume(-1), 0);
+	CHECK_EQ(radio.incVolume(), 1);
+	CHECK_EQ(radio.incVolume(), 2);
+	CHECK_EQ(radio.decVolume(), 1);
+	CHECK_EQ(radio.decVolume(), 0);
+	CHECK_EQ(radio.decVolume(), 0);
+}
+
+TEST(mono_mute_volext)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	radio.setMono(true);
+	CHECK(radio.getMono());
+	CHECK(sim.reg(0x02) & 0x2000);
+	radio.setMono(false);
+	CHECK(!radio.getMono());
+	CHECK(!(sim.reg(0x02) & 0x2000));
+
+	radio.setMute(false);
+	CHECK(!radio.getMute());
+	CHECK(!(sim.reg(0x02) & 0x4000));						// DMUTE
+	radio.setMute(true);
+	CHECK(radio.getMute());
+	CHECK(sim.reg(0x02) & 0x4000);
+
+	radio.setVolExt(true);
+	CHECK(radio.getVolExt());
+	CHECK(sim.reg(0x06) & 0x0100);
+	radio.setVolExt(false);
+	CHECK(!radio.getVolExt());
+	CHECK(!(sim.reg(0x06) & 0x0100));
+}
+
+TEST(writeGPIO)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	radio.writeGPIO(GPIO1, GPIO_High);
+	radio.writeGPIO(GPIO3, GPIO_Low);
+	CHECK_EQ(sim.reg(0x04) & 0x03, GPIO_High);
+	CHECK_EQ((sim.reg(0x04) >> 4) & 0x03, GPIO_Low);
+
+	radio.writeGPIO(GPIO2, GPIO_Low);
+	CHECK_EQ(digitalRead(3), LOW);
+	radio.writeGPIO(GPIO2, GPIO_High);
+	CHECK_EQ(digitalRead(3), HIGH);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Write-back cache and transactions
+//------------------------------------------------------------------------------------------------------------
+TEST(getWriteBytes_truncated_writes)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	CHECK_EQ(radio.getWriteBytes(), 12);					// Full control register set
+
+	radio.setMono(true);
+	CHECK_EQ(radio.getWriteBytes(), 2);						// POWERCFG only
+	radio.setVolume(3);
+	CHECK_EQ(radio.getWriteBytes(), 8);						// POWERCFG - SYSCONFIG2
+
+	unsigned long writes = Wire.writes;
+	radio.setVolume(3);										// No change
+	CHECK_EQ(Wire.writes, writes);
+}
+
+TEST(beginUpdate_commit)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	unsigned long writes = Wire.writes;
+	radio.beginUpdate();
+	radio.setVolume(9);
+	radio.setMono(true);
+	radio.beginUpdate();									// Nested
+	radio.setVolExt(true);
+	CHECK_EQ(radio.commit(), 0);
+	CHECK_EQ(Wire.writes, writes);							// Inner commit doesn't write
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 0);
+
+	CHECK_EQ(radio.commit(), 0);
+	CHECK_EQ(Wire.writes, writes + 1);						// One write for everything
+	CHECK_EQ(radio.getWriteBytes(), 10);
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 9);
+	CHECK(sim.reg(0x02) & 0x2000);
+	CHECK(sim.reg(0x06) & 0x0100);
+
+	CHECK_EQ(radio.commit(), 0);							// Unbalanced commit is harmless
+	CHECK_EQ(Wire.writes, writes + 1);
+}
+
+TEST(Si4703_Update_scope)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	unsigned long writes = Wire.writes;
+	{
+		Si4703_Update update(radio);
+		radio.setVolume(4);
+		radio.setMute(false);
+		CHECK_EQ(Wire.writes, writes);
+	}
+	CHECK_EQ(Wire.writes, writes + 1);
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 4);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Statistics
+//------------------------------------------------------------------------------------------------------------
+TEST(getStats_bus_traffic)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+
+	si4703Stats_t st;
+	CHECK(radio.getStats(st));
+	CHECK_EQ(st.getShadow, 1);								// Primed once by powerUp()
+	CHECK_EQ(st.bytesRead, Wire.bytesRead);
+	CHECK_EQ(st.bytesWritten, Wire.bytesWritten);
+	CHECK_EQ(st.putShadow, Wire.writes);
+	CHECK_EQ(st.writeErrors, 0);
+	CHECK(st.blockUs[STATS_START] >= 540000);
+	CHECK_EQ(st.blockUs[STATS_POWERUP], 0);					// Counted for start()
+
+	radio.resetStats();
+	radio.setVolume(3);
+	CHECK(radio.getStats(st, true));
+	CHECK_EQ(st.putShadow, 1);
+	CHECK_EQ(st.bytesWritten, 8);
+	CHECK_EQ(st.bytesRead, 0);
+
+	CHECK(radio.getStats(st));								// Reset by the previous snapshot
+	CHECK_EQ(st.putShadow, 0);
+}
+
+TEST(getStats_blocking_time)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.resetStats();
+
+	radio.setChannel(9440);
+	radio.incChannel();
+	si4703Stats_t st;
+	radio.getStats(st, true);
+	CHECK(st.blockUs[STATS_TUNE] >= 2 * 60000);
+	CHECK(st.stcPolls > 0);
+
+	radio.seekUp();
+	radio.getStats(st, true);
+	CHECK(st.blockUs[STATS_SEEK] >= 60000);
+	CHECK_EQ(st.blockUs[STATS_TUNE], 0);
+
+	station_t list[4];
+	radio.scanBand(list, 4);
+	radio.getStats(st, true);
+	CHECK(st.blockUs[STATS_SCAN] > 0);
+	CHECK_EQ(st.blockUs[STATS_SEEK], 0);					// Counted for scanBand()
+	CHECK_EQ(st.blockUs[STATS_TUNE], 0);
+}
+
+TEST(getStats_interrupt_saves_stc_polls)
+{
+	setup();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setInterrupt(true);
+	radio.resetStats();
+
+	radio.setChannel(9440);
+	si4703Stats_t st;
+	radio.getStats(st);
+	CHECK_EQ(st.stcPolls, 1);								// Read once after the interrupt
+}
+
+TEST(stc_polls_per_tune)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.resetStats();
+
+	for (int i = 0; i < 20; i++)
+		radio.setChannel(i & 1 ? 9000 : 9440);
+	si4703Stats_t st;
+	radio.getStats(st, true);
+	CHECK_EQ(st.tunes, 20);
+	CHECK(st.stcPolls <= 2 * st.tunes);						// Was a tight loop: about 220 per tune
+	CHECK(st.tuneUs / st.tunes < 60000 + 1500);				// 60 ms tune + writes, polls and STC clear
+	CHECK(radio.getTuneEstimate() > 58000 && radio.getTuneEstimate() <= 61000);
+
+	sim.tuneTime = 90000;									// Slower tuner: learned
+	for (int i = 0; i < 30; i++)
+		radio.setChannel(i & 1 ? 9000 : 9440);
+	radio.resetStats();
+	for (int i = 0; i < 20; i++)
+		radio.setChannel(i & 1 ? 9000 : 9440);
+	radio.getStats(st);
+	CHECK(st.stcPolls <= 2 * st.tunes);
+	CHECK(st.tuneUs / st.tunes < 90000 + 1500);
+	CHECK(radio.getTuneEstimate() > 87000 && radio.getTuneEstimate() <= 91000);
+}
+
+TEST(stc_polls_per_seek)
+{
+	setup();
+	for (int f = 8850; f <= 10750; f += 100)				// A station every 10 channels
+		sim.addStation(f, 40);
+	sim.seekChannelTime = 50000;
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8750);
+
+	for (int i = 0; i < 20; i++)
+		radio.seekUp();
+	CHECK(radio.getSeekEstimate() > 45000 && radio.getSeekEstimate() < 55000);
+
+	radio.setChannel(8750);
+	radio.resetStats();
+	for (int i = 0; i < 10; i++)
+		radio.seekUp();
+	si4703Stats_t st;
+	radio.getStats(st);
+	CHECK_EQ(st.seeks, 10);
+	CHECK(st.stcPolls <= 10 * (10 + 2));					// About one poll per channel
+	CHECK(st.seekUs / st.seeks < 10 * 50000 + 50000);		// Less than a channel late
+}
+
+TEST(getStats_write_errors)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.resetStats();
+
+	Wire.reset();											// Device gone
+	Wire.begin();
+	radio.setVolume(5);
+	si4703Stats_t st;
+	radio.getStats(st);
+	CHECK_EQ(st.writeErrors, 10);							// Default 10 attempts
+	CHECK_EQ(st.retries, 9);
+	CHECK_EQ(st.putShadow, 1);
+	CHECK_EQ(st.bytesWritten, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Errors
+//------------------------------------------------------------------------------------------------------------
+TEST(bus_retry_recovers)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.resetStats();
+
+	sim.nack = 3;											// Next 3 transactions fail
+	radio.setVolume(5);
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 5);
+	CHECK_EQ(radio.getError(), Si4703::ERR_NONE);
+
+	int rssi = radio.getRSSI();
+	sim.nack = 2;
+	CHECK_EQ(radio.getRSSI(), rssi);						// Read succeeds on the third attempt
+	si4703Stats_t st;
+	radio.getStats(st);
+	CHECK_EQ(st.writeErrors, 3);
+	CHECK_EQ(st.retries, 5);
+	CHECK_EQ(radio.getError(), Si4703::ERR_NONE);
+}
+
+TEST(getChannel_bus_error)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	radio.setRetries(1);
+
+	sim.nack = 1;
+	CHECK_EQ(radio.getChannel(), 0);						// Not the channel of the last read
+	CHECK_EQ(radio.getError(), Si4703::ERR_BUS);
+	sim.nack = 1;
+	CHECK_EQ(radio.incChannel(), 0);
+	CHECK_EQ(sim.freq(), 9440);								// Not retuned from a stale channel
+
+	station_t list[10];
+	sim.nack = 1;
+	CHECK_EQ(radio.scanBand(list, 10), 0);
+	CHECK_EQ(sim.freq(), 9440);
+
+	uint8_t rssi;
+	sim.nack = 1;
+	CHECK(!radio.checkAF(10110, 0x1234, 20, 300, rssi));
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK_EQ(radio.getChannel(), 9440);
+}
+
+TEST(sleep_bus_error)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	radio.setRetries(1);
+
+	sim.nack = 1;
+	CHECK_EQ(radio.sleep(), Si4703::ERR_BUS);				// Channel to resume unknown
+	CHECK(!radio.isAsleep());
+	CHECK(sim.isPowered());
+
+	CHECK_EQ(radio.sleep(), Si4703::ERR_NONE);
+	CHECK_EQ(radio.resume(), Si4703::ERR_NONE);
+	CHECK_EQ(sim.freq(), 9440);
+}
+
+TEST(start_without_device)
+{
+	setup();
+	Wire.reset();											// Nothing on the bus
+	Si4703 radio;
+	CHECK_EQ(radio.start(), Si4703::ERR_BUS);
+	CHECK_EQ(radio.getError(), Si4703::ERR_BUS);
+	CHECK_EQ(radio.getError(), Si4703::ERR_NONE);			// Cleared by getError()
+	CHECK(millis() < 10);									// No oscillator/power up wait
+}
+
+TEST(setChannel_timeout)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.resetStats();
+
+	sim.missSTC = true;										// STC never comes
+	unsigned long t = millis();
+	CHECK_EQ(radio.setChannel(9440), 0);
+	CHECK_EQ(radio.getError(), Si4703::ERR_TIMEOUT);
+	CHECK(millis() - t >= 250 && millis() - t < 260);		// Default tune timeout
+	CHECK(!radio.isBusy());
+	CHECK_EQ(sim.reg(0x03) & 0x8000, 0);					// TUNE cleared
+	si4703Stats_t st;
+	radio.getStats(st);
+	CHECK_EQ(st.timeouts, 1);
+
+	sim.missSTC = false;
+	CHECK_EQ(radio.setChannel(9440), 9440);					// Recovers
+}
+
+TEST(seek_timeout_callback)
+{
+	setup();
+	band();
+	Si4703 radio;
+	radio.start();
+	radio.setTimeout(100, 1000);
+
+	sim.missSTC = true;
+	doneCalls = 0;
+	unsigned long t = millis();
+	CHECK(radio.beginSeek(Si4703::SEEK_UP, done));
+	wait(radio);
+	CHECK_EQ(doneCalls, 1);
+	CHECK_EQ(doneFreq, 0);
+	CHECK(doneSFBL);
+	CHECK_EQ(radio.getError(), Si4703::ERR_TIMEOUT);
+	CHECK(millis() - t >= 1000 && millis() - t < 1050);
+	CHECK_EQ(sim.reg(0x02) & 0x0100, 0);					// SEEK cleared
+
+	t = millis();
+	CHECK_EQ(radio.setChannel(9440), 0);					// Tune timeout is 100ms now
+	CHECK(millis() - t >= 100 && millis() - t < 110);
+}
+
+TEST(setRetries)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setRetries(1);
+
+	sim.nack = 1;
+	radio.setVolume(5);										// No second attempt
+	CHECK_EQ(radio.getError(), Si4703::ERR_BUS);
+	CHECK((sim.reg(0x05) & 0x0F) != 5);
+
+	radio.setVolume(6);										// Next write succeeds
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 6);
+}
+
+int main()
+{
+	return unit::run();
+}
@@ -0,0 +1,207 @@
+/*
+ *  Alternative Frequencies: checkAF() and Si4703_AF tables and following
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703.h"
+#include "Si4703_AF.h"
+
+static Si4703Sim sim;					// RST pin 4, SDIO A4, GPIO2 on pin 3
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture: program 0x1234 on 94.4 and 101.1, another program on 91.1, listed as AF by 94.4
+//------------------------------------------------------------------------------------------------------------
+static void groups(int freq, uint16_t pi, const uint16_t *af)
+{
+	for (int seg = 0; seg < 4; seg++)
+		sim.addGroup(freq, pi, 0x0000 | seg, af[seg], 0x4142);
+}
+
+static void setup(void)
+{
+	static const uint16_t af9440[4]  = { ((224 + 3) << 8) | 36, (69 << 8) | 136, ((224 + 3) << 8) | 36, (69 << 8) | 136 };
+	static const uint16_t af10110[4] = { ((224 + 2) << 8) | 136, (69 << 8) | 205, ((224 + 2) << 8) | 136, (69 << 8) | 205 };
+	static const uint16_t none[4]    = { 0xE0CD, 0xE0CD, 0xE0CD, 0xE0CD };
+
+	host::reset();
+	Wire.reset();
+	sim.reset();
+	sim.connect();
+	sim.addStation(9440, 40);
+	sim.addStation(10110, 45);
+	sim.addStation(9110, 50);
+	groups(9440, 0x1234, af9440);
+	groups(10110, 0x1234, af10110);
+	groups(9110, 0x5555, none);
+}
+
+// Run loop() for ms
+static void run(Si4703 &radio, Si4703_Monitor &mon, Si4703_AF &af, unsigned long ms)
+{
+	unsigned long t = millis();
+	while (millis() - t < ms)
+	{
+		mon.poll(radio);
+		radio.readRDS();
+		af.poll(radio, mon);
+		delay(20);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------
+// checkAF()
+//------------------------------------------------------------------------------------------------------------
+TEST(checkAF_switches_on_same_pi)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setMute(true);									// Audio on (DMUTE)
+	radio.setChannel(9440);
+
+	uint8_t rssi;
+	CHECK(radio.checkAF(10110, 0x1234, 20, 300, rssi));
+	CHECK_EQ(rssi, 45);
+	CHECK_EQ(radio.getChannel(), 10110);
+	CHECK_EQ(radio.rds.getPI(), 0x1234);					// Kept for the new channel
+	CHECK(sim.reg(0x02) & 0x4000);							// Audio back on
+	CHECK(radio.getAFTime() <= 60 + 300 + 10);
+}
+
+TEST(checkAF_returns_on_other_pi)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setMute(true);
+	radio.setChannel(9440);
+
+	uint8_t rssi;
+	unsigned long t = millis();
+	CHECK(!radio.checkAF(9110, 0x1234, 20, 300, rssi));
+	CHECK_EQ(rssi, 50);
+	CHECK_EQ(radio.getChannel(), 9440);
+	CHECK(sim.reg(0x02) & 0x4000);
+	CHECK(radio.getAFTime() < 60 + 300 + 60 + 10);			// Two tunes and at most the window
+	CHECK(millis() - t - radio.getAFTime() <= 1);
+}
+
+TEST(checkAF_rds_interrupt_no_stale_pi)
+{
+	setup();
+	sim.addStation(10500, 45);								// No RDS
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+	radio.setRDSInterrupt(true);
+	delay(600);												// Groups of 94.4 queued
+	CHECK(radio.getGroupCount() >= 6);
+
+	uint8_t rssi;
+	CHECK(!radio.checkAF(10500, 0x1234, 20, 300, rssi));	// Not confirmed by the PI of 94.4
+	CHECK_EQ(rssi, 45);
+	CHECK_EQ(radio.getChannel(), 9440);
+
+	CHECK(radio.checkAF(10110, 0x1234, 20, 300, rssi));		// Confirmed from captured groups
+	CHECK_EQ(radio.getChannel(), 10110);
+}
+
+TEST(checkAF_weak_af_no_wait)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+
+	uint8_t rssi;
+	CHECK(!radio.checkAF(10110, 0x1234, 50, 300, rssi));	// 45 is too weak
+	CHECK_EQ(rssi, 45);
+	CHECK_EQ(radio.getChannel(), 9440);
+	CHECK(radio.getAFTime() < 2 * 60 + 10);					// No PI wait
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Si4703_AF
+//------------------------------------------------------------------------------------------------------------
+TEST(tables_per_program)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+
+	Si4703_Monitor mon;
+	Si4703_AF af;
+	run(radio, mon, af, 1000);
+	CHECK_EQ(af.getPI(), 0x1234);
+	CHECK_EQ(af.getAFCount(0x1234), 3);
+	CHECK_EQ(af.getAF(0x1234, 0), 9110);
+	CHECK_EQ(af.getAF(0x1234, 1), 9440);
+	CHECK_EQ(af.getAF(0x1234, 2), 10110);
+	CHECK_EQ(af.getChecks(), 0);							// Not enabled
+
+	radio.setChannel(9110);									// Another program
+	run(radio, mon, af, 1000);
+	CHECK_EQ(af.getPI(), 0x5555);
+	CHECK_EQ(af.getAFCount(0x5555), 0);
+	CHECK_EQ(af.getAFCount(0x1234), 3);						// Kept
+}
+
+TEST(follow_when_signal_fades)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+
+	Si4703_Monitor mon;
+	Si4703_AF af;
+	af.enable(true);
+	run(radio, mon, af, 2000);
+	CHECK_EQ(af.getChecks(), 0);							// Strong enough
+
+	sim.setStation(9440, 10);								// Fades
+	run(radio, mon, af, 3000);
+	CHECK_EQ(radio.getChannel(), 10110);
+	CHECK_EQ(af.getSwitches(), 1);
+	CHECK_EQ(af.getChecks(), 2);							// 91.1 (other PI), then 101.1
+	CHECK(af.getLastOffTime() <= 60 + 200 + 10);
+	CHECK(af.getOffTime() <= 2 * 60 + 200 + 60 + 200 + 20);
+
+	run(radio, mon, af, 2000);								// Strong on 101.1: stays
+	CHECK_EQ(radio.getChannel(), 10110);
+	CHECK_EQ(af.getSwitches(), 1);
+}
+
+TEST(hold_off_between_rounds)
+{
+	setup();
+	sim.setStation(10110, 5);								// No usable AF
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+
+	Si4703_Monitor mon;
+	Si4703_AF af;
+	af.enable(true);
+	af.setHoldOff(5000);
+	af.setMaxChecks(1);
+	run(radio, mon, af, 1500);								// Table filled
+
+	sim.setStation(9440, 10);
+	run(radio, mon, af, 2000);
+	CHECK_EQ(af.getChecks(), 1);							// Best untried AF only
+	CHECK_EQ(radio.getChannel(), 9440);
+	run(radio, mon, af, 5000);
+	CHECK_EQ(af.getChecks(), 2);							// Next round after the hold off
+	CHECK_EQ(af.getSwitches(), 0);
+	CHECK_EQ(radio.getChannel(), 9440);
+}
+
+int main()
+{
+	return unit::run();
+}
@@ -0,0 +1,201 @@
+/*
+ *  Si4703T over the bus transports: TwoWire instance, 3-wire and the simulator transport
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703SimBus.h"
+#include "Si4703.h"
+
+static TwoWire		Wire1;						// Second I2C peripheral
+static Si4703Sim	sim(4, A4, 3, A5, 5);		// RST pin 4, SDIO A4, GPIO2 pin 3, SCLK A5, SEN pin 5
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture
+//------------------------------------------------------------------------------------------------------------
+static void setup(void)
+{
+	host::reset();
+	Wire.reset();
+	Wire1.reset();
+	sim.reset();
+	sim.addStation(8810, 40);
+	sim.addStation(9440, 50, false);
+	sim.addStation(10110, 35);
+}
+
+static void psGroups(int freq, uint16_t pi, const char *ps)
+{
+	for (int seg = 0; seg < 4; seg++)
+		sim.addGroup(freq, pi, 0x0000 | seg, 0xE0CD, (ps[seg * 2] << 8) | ps[seg * 2 + 1]);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// TwoWire instance
+//------------------------------------------------------------------------------------------------------------
+TEST(twowire_instance)
+{
+	setup();
+	sim.connect(Wire1);
+	Si4703T<Si4703_TwoWire> radio(Si4703_TwoWire(Wire1, A4));
+
+	CHECK_EQ(radio.start(), Si4703::ERR_NONE);
+	CHECK(sim.isI2C());
+	CHECK(sim.isPowered());
+	CHECK_EQ(radio.setChannel(9440), 9440);
+	CHECK_EQ(radio.getRSSI(), 50);
+	CHECK(Wire1.writes > 0);
+	CHECK_EQ(Wire.writes + Wire.reads, 0);					// Default Wire not used
+}
+
+//------------------------------------------------------------------------------------------------------------
+// 3-wire
+//------------------------------------------------------------------------------------------------------------
+TEST(threewire_start)
+{
+	setup();
+	sim.connectPins();
+	Si4703T<Si4703_3Wire> radio(Si4703_3Wire(5, A4, A5));
+
+	CHECK_EQ(radio.start(), Si4703::ERR_NONE);
+	CHECK(sim.is3Wire());
+	CHECK(!sim.isI2C());
+	CHECK(sim.isPowered());
+	CHECK(sim.oscSettled());
+	CHECK_EQ(radio.getPN(), 0x1);
+	CHECK_EQ(radio.getMFGID(), 0x242);
+	CHECK_EQ(radio.getDEV(), 0x9);
+	CHECK(sim.reg(0x04) & 0x1000);							// RDS enabled
+	CHECK_EQ((sim.reg(0x05) >> 8), 24);						// SEEKTH
+	CHECK_EQ(Wire.writes + Wire.reads, 0);					// Off the I2C bus
+}
+
+TEST(threewire_tune_seek_volume)
+{
+	setup();
+	sim.connectPins();
+	Si4703T<Si4703_3Wire> radio(Si4703_3Wire(5, A4, A5));
+	radio.start();
+
+	CHECK_EQ(radio.setChannel(9440), 9440);
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK_EQ(radio.getRSSI(), 50);
+	CHECK(!radio.getST());
+	CHECK_EQ(radio.seekUp(), 10110);
+	CHECK_EQ(radio.getChannel(), 10110);
+	CHECK(radio.getST());
+
+	radio.setVolume(7);
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 7);
+	{
+		Si4703_UpdateT<Si4703T<Si4703_3Wire> > update(radio);
+		radio.setMono(true);
+		radio.setVolume(3);
+	}
+	CHECK_EQ(sim.reg(0x05) & 0x0F, 3);
+	CHECK(sim.reg(0x02) & 0x2000);							// MONO
+}
+
+TEST(threewire_rds)
+{
+	setup();
+	psGroups(9440, 0x1234, "TEST FM ");
+	sim.connectPins();
+	Si4703T<Si4703_3Wire> radio(Si4703_3Wire(5, A4, A5));
+	radio.start();
+	radio.setChannel(9440);
+
+	unsigned long t = millis();
+	while (!radio.rds.hasPS() && millis() - t < 2000)
+	{
+		radio.readRDS();
+		delay(20);
+	}
+	CHECK(radio.rds.hasPS());
+	CHECK_EQ(radio.rds.getPI(), 0x1234);
+	CHECK(strcmp(radio.rds.getPS(), "TEST FM ") == 0);
+}
+
+TEST(threewire_warmStart)
+{
+	setup();
+	sim.connectPins();
+	{
+		Si4703T<Si4703_3Wire> radio(Si4703_3Wire(5, A4, A5));
+		radio.start();
+		radio.setChannel(8810);
+	}
+
+	Si4703T<Si4703_3Wire> radio(Si4703_3Wire(5, A4, A5));	// MCU reset
+	CHECK(radio.warmStart());
+	CHECK_EQ(radio.getChannel(), 8810);
+	CHECK(sim.is3Wire());
+}
+
+TEST(threewire_no_device)
+{
+	setup();												// Simulator not connected
+	Si4703T<Si4703_3Wire> radio(Si4703_3Wire(5, A4, A5));
+	CHECK_EQ(radio.start(), Si4703::ERR_DEVICE);			// No acknowledge, found by DEVICEID
+}
+
+TEST(sen_not_wired_no_3wire_mode)
+{
+	setup();
+	Si4703Sim other(4, A4, 3);								// SEN only pulled high
+	other.connectPins();
+	Si4703T<Si4703_3Wire> radio(Si4703_3Wire(5, A4, A5));
+	radio.start();
+	CHECK(!other.is3Wire());
+	CHECK(!other.isPowered());
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Simulator transport
+//------------------------------------------------------------------------------------------------------------
+TEST(simbus_two_tuners)
+{
+	setup();
+	Si4703Sim simB(6, 7, 2);								// Second tuner: RST pin 6, SDIO pin 7, GPIO2 pin 2
+	simB.reset();
+	simB.addStation(10110, 45);
+	sim.connectPins();
+	simB.connectPins();
+
+	Si4703SimBus busA(sim, A4);
+	Si4703SimBus busB(simB, 7);
+	Si4703T<Si4703SimBus> radioA(busA, 4, 3);
+	Si4703T<Si4703SimBus> radioB(busB, 6, 2);
+
+	CHECK_EQ(radioA.start(), Si4703::ERR_NONE);
+	CHECK_EQ(radioB.start(), Si4703::ERR_NONE);
+	CHECK(sim.isPowered());
+	CHECK(simB.isPowered());
+
+	CHECK_EQ(radioA.setChannel(8810), 8810);
+	CHECK_EQ(radioB.setChannel(10110), 10110);
+	CHECK_EQ(sim.freq(), 8810);
+	CHECK_EQ(simB.freq(), 10110);
+	CHECK_EQ(radioA.getRSSI(), 40);
+	CHECK_EQ(radioB.getRSSI(), 45);
+	CHECK_EQ(Wire.writes + Wire.reads, 0);
+}
+
+TEST(simbus_timing_matches_wire)
+{
+	setup();
+	sim.connectPins();
+	Si4703T<Si4703SimBus> radio(Si4703SimBus(sim, A4));
+	radio.start();
+
+	unsigned long t = micros();
+	radio.getRSSI();										// 2 byte read
+	CHECK_EQ(micros() - t, 3 * 90);							// Address + 2 bytes at 100 kHz
+}
+
+int main()
+{
+	return unit::run();
+}
@@ -0,0 +1,94 @@
+/*
+ *  RDS interrupt capture read outside the ISR (SI4703_ISR_BUS 0, cores whose Wire can't run from an ISR)
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703.h"
+
+static Si4703Sim sim;					// RST pin 4, SDIO A4, GPIO2 on pin 3
+
+static_assert(SI4703_ISR_BUS == 0, "built with the capture outside the ISR");
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture: PS "TESTFM  " on 94.4
+//------------------------------------------------------------------------------------------------------------
+static void setup(void)
+{
+	static const char ps[] = "TESTFM  ";
+
+	host::reset();
+	Wire.reset();
+	sim.reset();
+	sim.connect();
+	sim.addStation(9440, 40);
+	sim.addStation(10110, 35);
+	for (int seg = 0; seg < 4; seg++)
+		sim.addGroup(9440, 0x1234, 0x0000 | seg, 0xE0CD, (ps[seg * 2] << 8) | ps[seg * 2 + 1]);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Tests
+//------------------------------------------------------------------------------------------------------------
+TEST(isr_does_not_use_the_bus)
+{
+	setup();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+	CHECK(radio.setRDSInterrupt(true));
+
+	unsigned long reads = Wire.reads;
+	unsigned long sent  = sim.groupsSent;
+	delay(500);
+	CHECK(sim.groupsSent - sent >= 5);
+	CHECK_EQ(Wire.reads, reads);							// Only flagged
+
+	sent = sim.groupsSent;
+	while (sim.groupsSent == sent) delay(1);				// RDSR of the next group is still up
+	CHECK_EQ(radio.getGroupCount(), 1);						// That group, read now
+	CHECK_EQ(Wire.reads - reads, 1);
+}
+
+TEST(readRDS_collects_every_group)
+{
+	setup();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setChannel(9440);
+	radio.setRDSInterrupt(true);
+
+	unsigned long sent = sim.groupsSent;
+	int accepted = 0;
+	for (int i = 0; i < 100; i++)							// 2 seconds
+	{
+		if (radio.readRDS()) accepted++;
+		delay(20);
+	}
+	if (radio.readRDS()) accepted++;
+	CHECK_EQ(accepted, (int)(sim.groupsSent - sent));		// One bus read per group, none lost
+	CHECK_EQ(radio.rds.getPI(), 0x1234);
+	CHECK(strcmp(radio.rds.getPS(), "TESTFM  ") == 0);
+}
+
+TEST(stc_interrupt_with_capture)
+{
+	setup();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	radio.setInterrupt(true);
+	radio.setRDSInterrupt(true);
+	CHECK_EQ(radio.setChannel(9440), 9440);
+	delay(500);
+	CHECK_EQ(radio.seekUp(), 10110);						// No group of 94.4 left
+	CHECK_EQ(radio.getGroupCount(), 0);
+	radio.readRDS();
+	CHECK_EQ(radio.rds.getPI(), 0);
+}
+
+int main()
+{
+	return unit::run();
+}
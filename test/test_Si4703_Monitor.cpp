@@ -0,0 +1,255 @@
+/*
+ *  Si4703_Monitor: sampling, averages, window min/max and hysteresis events
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703.h"
+
+static Si4703Sim sim;					// RST pin 4, SDIO A4, GPIO2 on pin 3
+
+static uint8_t	events[32];
+static int		eventCount;
+
+static void onEvent(uint8_t event, const signal_t &s)
+{
+	if (eventCount < 32) events[eventCount++] = event;
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture
+//------------------------------------------------------------------------------------------------------------
+static void setup(void)
+{
+	host::reset();
+	Wire.reset();
+	sim.reset();
+	sim.connect();
+	sim.addStation(8810, 40);
+	sim.addStation(9440, 50, false);
+	eventCount = 0;
+}
+
+static signal_t sample(uint8_t rssi, bool st = true, bool rdss = false, int freq = 9440)
+{
+	signal_t s = { freq, rssi, st, rdss, false };
+	return s;
+}
+
+// Run loop() for ms with the monitor polling
+static void run(Si4703_Monitor &mon, Si4703 &radio, unsigned long ms)
+{
+	unsigned long t = millis();
+	while (millis() - t < ms)
+	{
+		mon.poll(radio);
+		delay(1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Samples
+//------------------------------------------------------------------------------------------------------------
+TEST(readSignal_4_bytes)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8810);
+
+	unsigned long t = micros();
+	signal_t s;
+	CHECK_EQ(radio.readSignal(s), Si4703::ERR_NONE);
+	CHECK_EQ(micros() - t, 5 * 90);							// Address + 4 bytes at 100 kHz
+	CHECK_EQ(s.freq, 8810);
+	CHECK_EQ(s.rssi, 40);
+	CHECK(s.st);
+	CHECK(!s.rdss);
+}
+
+TEST(poll_interval)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8810);
+
+	Si4703_Monitor mon;
+	mon.setInterval(50);
+	uint32_t reads = Wire.reads;
+	run(mon, radio, 1000);
+	CHECK_EQ(mon.getSamples(), 20);
+	CHECK_EQ(Wire.reads - reads, 20);						// One read per sample
+	CHECK_EQ(mon.getRSSI(), 40);
+	CHECK_EQ(mon.getStereo(), 100);
+	CHECK(mon.hasSignal());
+	CHECK(mon.isStereo());
+}
+
+TEST(no_samples_while_seeking)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(8750);
+
+	Si4703_Monitor mon;
+	radio.beginSeek(Si4703::SEEK_UP);
+	while (radio.poll())
+	{
+		CHECK(!mon.poll(radio));
+		delay(1);
+	}
+	CHECK(mon.poll(radio));
+	CHECK_EQ(mon.getLast().freq, 8810);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Averages and windows
+//------------------------------------------------------------------------------------------------------------
+TEST(average_smooths)
+{
+	Si4703_Monitor mon;
+	mon.update(sample(40));
+	CHECK_EQ(mon.getRSSI(), 40);
+	mon.update(sample(0));									// One bad sample moves 1/8
+	CHECK_EQ(mon.getRSSI(), 35);
+	for (int i = 0; i < 60; i++) mon.update(sample(20));
+	CHECK_EQ(mon.getRSSI(), 20);
+
+	mon.reset();
+	mon.setSmoothing(0);									// No smoothing
+	mon.update(sample(40));
+	mon.update(sample(10));
+	CHECK_EQ(mon.getRSSI(), 10);
+}
+
+TEST(stereo_share)
+{
+	Si4703_Monitor mon;
+	mon.setSmoothing(1);
+	mon.update(sample(40, true));
+	mon.update(sample(40, false));
+	CHECK_EQ(mon.getStereo(), 50);
+}
+
+TEST(window_min_max)
+{
+	Si4703_Monitor mon;
+	mon.setWindow(4);
+	mon.update(sample(30));
+	mon.update(sample(25));
+	CHECK_EQ(mon.getMinRSSI(), 25);							// Current window until one completes
+	CHECK_EQ(mon.getMaxRSSI(), 30);
+	mon.update(sample(35));
+	mon.update(sample(28));
+	CHECK_EQ(mon.getMinRSSI(), 25);
+	CHECK_EQ(mon.getMaxRSSI(), 35);
+	mon.update(sample(40));									// Next window doesn't change the result
+	CHECK_EQ(mon.getMaxRSSI(), 35);
+	for (int i = 0; i < 3; i++) mon.update(sample(40));
+	CHECK_EQ(mon.getMinRSSI(), 40);
+	CHECK_EQ(mon.getMaxRSSI(), 40);
+}
+
+TEST(new_channel_starts_over)
+{
+	Si4703_Monitor mon;
+	mon.onEvent(onEvent);
+	eventCount = 0;
+	mon.update(sample(50, true, false, 9440));
+	mon.update(sample(50, true, false, 9440));
+	mon.update(sample(10, false, false, 8810));
+	CHECK_EQ(mon.getSamples(), 1);
+	CHECK_EQ(mon.getRSSI(), 10);
+	CHECK(!mon.hasSignal());
+	CHECK(!mon.isStereo());
+	CHECK_EQ(eventCount, 0);								// States set without events
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Events
+//------------------------------------------------------------------------------------------------------------
+TEST(signal_hysteresis)
+{
+	Si4703_Monitor mon;
+	mon.onEvent(onEvent);
+	mon.setSmoothing(0);
+	mon.setSignalThresholds(15, 20);
+	eventCount = 0;
+
+	mon.update(sample(30));
+	CHECK(mon.hasSignal());
+	mon.update(sample(17));									// Between thresholds: no change
+	CHECK_EQ(eventCount, 0);
+	mon.update(sample(14));
+	CHECK_EQ(eventCount, 1);
+	CHECK_EQ(events[0], MON_SIGNAL_LOST);
+	mon.update(sample(18));									// Between thresholds: still lost
+	mon.update(sample(16));
+	CHECK_EQ(eventCount, 1);
+	CHECK(!mon.hasSignal());
+	mon.update(sample(20));
+	CHECK_EQ(eventCount, 2);
+	CHECK_EQ(events[1], MON_SIGNAL_OK);
+}
+
+TEST(stereo_debounce)
+{
+	Si4703_Monitor mon;
+	mon.onEvent(onEvent);
+	mon.setDebounce(3);
+	eventCount = 0;
+
+	mon.update(sample(40, true));
+	mon.update(sample(40, false));							// Short dropouts are ignored
+	mon.update(sample(40, false));
+	mon.update(sample(40, true));
+	mon.update(sample(40, false));
+	mon.update(sample(40, false));
+	CHECK_EQ(eventCount, 0);
+	mon.update(sample(40, false));
+	CHECK_EQ(eventCount, 1);
+	CHECK_EQ(events[0], MON_STEREO_LOST);
+	CHECK(!mon.isStereo());
+	for (int i = 0; i < 3; i++) mon.update(sample(40, true));
+	CHECK_EQ(eventCount, 2);
+	CHECK_EQ(events[1], MON_STEREO);
+}
+
+TEST(fading_station_events)
+{
+	setup();
+	for (int seg = 0; seg < 4; seg++)
+		sim.addGroup(9440, 0x1234, 0x0000 | seg, 0xE0CD, 0x4142);
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+
+	Si4703_Monitor mon;
+	mon.onEvent(onEvent);
+	run(mon, radio, 1000);									// RDS synchronizes with the first group
+	CHECK_EQ(eventCount, 1);
+	CHECK_EQ(events[0], MON_RDS_SYNC);
+	CHECK(mon.isRDSSync());
+	CHECK(!mon.isStereo());
+
+	sim.setStation(9440, 5, false);							// Fades out
+	run(mon, radio, 2000);
+	CHECK_EQ(eventCount, 2);
+	CHECK_EQ(events[1], MON_SIGNAL_LOST);
+	CHECK_EQ(mon.getMinRSSI(), 5);
+
+	sim.setStation(9440, 45, true);							// Back, now stereo
+	run(mon, radio, 2000);
+	CHECK_EQ(eventCount, 4);
+	CHECK_EQ(events[2], MON_SIGNAL_OK);
+	CHECK_EQ(events[3], MON_STEREO);
+}
+
+int main()
+{
+	return unit::run();
+}
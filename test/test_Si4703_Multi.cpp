@@ -0,0 +1,270 @@
+/*
+ *  Si4703_Multi: band surveys split across several tuners on their own buses
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703SimBus.h"
+#include "Si4703_Multi.h"
+
+typedef Si4703T<Si4703SimBus>	Radio;
+
+static const int	TUNERS	= 4;
+
+static Si4703Sim	sims[TUNERS] = {					// RST, SDIO, GPIO2 pins of each tuner
+	Si4703Sim( 4, A4,  3),
+	Si4703Sim( 6,  7,  2),
+	Si4703Sim( 8,  9, 10),
+	Si4703Sim(11, 12, 13),
+};
+static const int	rstPins[TUNERS]		= {  4,  6,  8, 11 };
+static const int	sdioPins[TUNERS]	= { A4,  7,  9, 12 };
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture: every tuner receives the same stations
+//------------------------------------------------------------------------------------------------------------
+static void setup(void)
+{
+	host::reset();
+	Wire.reset();
+	for (int i = 0; i < TUNERS; i++)
+	{
+		Si4703Sim &sim = sims[i];
+		sim.reset();
+		sim.connectPins();
+		sim.addStation(8810, 40);
+		sim.addStation(9440, 50, false);
+		sim.addStation(9780, 45);						// Bottom of the second of two slices
+		sim.addStation(10110, 35);
+		sim.addStation(10700, 30);
+	}
+}
+
+static void psGroups(Si4703Sim &sim, int freq, uint16_t pi, const char *ps)
+{
+	for (int seg = 0; seg < 4; seg++)
+		sim.addGroup(freq, pi, 0x0000 | seg, 0xE0CD, (ps[seg * 2] << 8) | ps[seg * 2 + 1]);
+}
+
+// Scan with one tuner, the reference for the multi-tuner scans
+static int scanOne(station_t *list, int max, uint8_t mode, unsigned long &time)
+{
+	Radio radio(Si4703SimBus(sims[0], sdioPins[0]), rstPins[0]);
+	radio.start();
+	int n = radio.scanBand(list, max, mode);
+	time  = radio.getScanTime();
+	return n;
+}
+
+// Scan with n tuners on their own buses
+template <int N>
+static int scanMulti(station_t *list, int max, uint8_t mode, unsigned long &time, unsigned int piWait = 0)
+{
+	Si4703SimBus	*bus[N];
+	Radio			*radio[N];
+	Si4703_Multi<Radio, N> tuners;
+
+	for (int i = 0; i < N; i++)
+	{
+		bus[i]   = new Si4703SimBus(sims[i], sdioPins[i]);
+		radio[i] = new Radio(*bus[i], rstPins[i]);
+		radio[i]->start();
+		radio[i]->setChannel(9000 + i * 100);
+		CHECK(tuners.add(*radio[i]));
+	}
+	CHECK(!tuners.add(*radio[0]));						// Full
+
+	int n = tuners.scanBand(list, max, mode, piWait);
+	time  = tuners.getScanTime();
+
+	for (int i = 0; i < N; i++)
+	{
+		CHECK_EQ(radio[i]->getChannel(), 9000 + i * 100);	// Back on the original channel
+		delete radio[i];
+		delete bus[i];
+	}
+	return n;
+}
+
+static bool sameStations(const station_t *a, const station_t *b, int n)
+{
+	for (int i = 0; i < n; i++)
+		if (a[i].freq != b[i].freq || a[i].rssi != b[i].rssi || a[i].st != b[i].st) return false;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Tests
+//------------------------------------------------------------------------------------------------------------
+TEST(seek_two_tuners_same_stations_faster)
+{
+	station_t one[10], two[10];
+	unsigned long tOne, tTwo;
+
+	setup();
+	int n1 = scanOne(one, 10, SCAN_SEEK, tOne);
+	setup();
+	int n2 = scanMulti<2>(two, 10, SCAN_SEEK, tTwo);
+
+	CHECK_EQ(n1, 5);
+	CHECK_EQ(n2, n1);
+	CHECK(sameStations(one, two, n1));
+	CHECK(tTwo < tOne * 2 / 3);
+}
+
+TEST(seek_four_tuners)
+{
+	station_t one[10], four[10];
+	unsigned long tOne, tFour;
+
+	setup();
+	int n1 = scanOne(one, 10, SCAN_SEEK, tOne);
+	setup();
+	int n4 = scanMulti<4>(four, 10, SCAN_SEEK, tFour);
+
+	CHECK_EQ(n4, n1);
+	CHECK(sameStations(one, four, n1));
+	CHECK(tFour < tOne / 2);
+}
+
+TEST(step_merges_peaks_across_slices)
+{
+	station_t one[10], two[10];
+	unsigned long tOne, tTwo;
+
+	setup();
+	for (int i = 0; i < TUNERS; i++)
+	{
+		sims[i].addStation(9770, 30);					// Shoulders of 97.8 on both sides of the slice boundary
+		sims[i].addStation(9790, 28);
+	}
+	int n1 = scanOne(one, 10, SCAN_STEP, tOne);
+	setup();
+	for (int i = 0; i < TUNERS; i++)
+	{
+		sims[i].addStation(9770, 30);
+		sims[i].addStation(9790, 28);
+	}
+	int n2 = scanMulti<2>(two, 10, SCAN_STEP, tTwo);
+
+	CHECK_EQ(n1, 5);
+	CHECK_EQ(n2, n1);
+	CHECK(sameStations(one, two, n1));
+	CHECK_EQ(two[2].freq, 9780);
+	CHECK(tTwo < tOne * 2 / 3);
+}
+
+TEST(list_full_stops)
+{
+	station_t list[2];
+	unsigned long t;
+
+	setup();
+	CHECK_EQ(scanMulti<2>(list, 2, SCAN_SEEK, t), 2);
+	CHECK(list[0].freq < list[1].freq);
+}
+
+TEST(piWait_on_each_tuner)
+{
+	station_t list[10];
+	unsigned long t;
+
+	setup();
+	psGroups(sims[0], 9440, 0xC201, "RADIO 1 ");		// 94.4 is in the first slice
+	psGroups(sims[1], 10110, 0xC202, "RADIO 2 ");		// 101.1 is in the second slice
+	int n = scanMulti<2>(list, 10, SCAN_SEEK, t, 500);
+
+	CHECK_EQ(n, 5);
+	CHECK_EQ(list[0].pi, 0);
+	CHECK_EQ(list[1].freq, 9440);
+	CHECK_EQ(list[1].pi, 0xC201);
+	CHECK_EQ(list[3].freq, 10110);
+	CHECK_EQ(list[3].pi, 0xC202);
+}
+
+TEST(piWait_rds_interrupt)
+{
+	setup();
+	psGroups(sims[0], 9440, 0xC201, "RADIO 1 ");
+	Si4703SimBus busA(sims[0], sdioPins[0]);
+	Si4703SimBus busB(sims[1], sdioPins[1]);
+	Radio radioA(busA, rstPins[0], 3);						// GPIO2 of the first tuner on pin 3
+	Radio radioB(busB, rstPins[1]);
+	radioA.start();
+	radioB.start();
+	radioA.setChannel(9440);
+	CHECK(radioA.setRDSInterrupt(true));
+	delay(600);												// Groups of 94.4 queued
+
+	Si4703_Multi<Radio, 2> tuners;
+	tuners.add(radioA);
+	tuners.add(radioB);
+	station_t list[10];
+	CHECK_EQ(tuners.scanBand(list, 10, SCAN_SEEK, 500), 5);
+	CHECK_EQ(list[0].freq, 8810);
+	CHECK_EQ(list[0].pi, 0);								// Not the PI of 94.4
+	CHECK_EQ(list[1].pi, 0xC201);
+}
+
+TEST(seek_wrap_mode_stops_at_band_end)
+{
+	setup();
+	Si4703SimBus busA(sims[0], sdioPins[0]);
+	Si4703SimBus busB(sims[1], sdioPins[1]);
+	Radio radioA(busA, rstPins[0], 0, BAND_US_EU, SPACE_100KHz, DE_75us, SKMODE_WRAP);
+	Radio radioB(busB, rstPins[1], 0, BAND_US_EU, SPACE_100KHz, DE_75us, SKMODE_WRAP);
+	radioA.start();
+	radioB.start();
+	radioA.setChannel(9000);
+	radioB.setChannel(9100);
+	uint16_t powercfg = sims[1].reg(0x02);
+
+	Si4703_Multi<Radio, 2> tuners;
+	tuners.add(radioA);
+	tuners.add(radioB);
+	station_t list[10];
+	CHECK_EQ(tuners.scanBand(list, 10, SCAN_SEEK), 5);
+	CHECK_EQ(list[4].freq, 10700);
+	CHECK(sims[1].seekChannels <= 11);						// Last seek stopped at the band limit, no wrap to 88.1
+	CHECK_EQ(sims[1].reg(0x02), powercfg);					// Mute and SKMODE_WRAP restored
+	CHECK_EQ(radioB.getChannel(), 9100);
+}
+
+TEST(poll_runs_seeks_in_parallel)
+{
+	setup();
+	Si4703SimBus busA(sims[0], sdioPins[0]);
+	Si4703SimBus busB(sims[1], sdioPins[1]);
+	Radio radioA(busA, rstPins[0]);
+	Radio radioB(busB, rstPins[1]);
+	radioA.start();
+	radioB.start();
+	radioA.setChannel(8750);
+	radioB.setChannel(10300);
+
+	Si4703_Multi<Radio, 2> tuners;
+	tuners.add(radioA);
+	tuners.add(radioB);
+	CHECK_EQ(tuners.count(), 2);
+
+	unsigned long t = millis();
+	CHECK(tuners[0].beginSeek(Radio::SEEK_UP));
+	CHECK(tuners[1].beginSeek(Radio::SEEK_UP));
+	while (tuners.poll()) delay(1);
+
+	CHECK_EQ(radioA.getChannel(), 8810);
+	CHECK_EQ(radioB.getChannel(), 10700);
+	CHECK(millis() - t < 40 * 30 + 100);				// The longer seek (40 channels) only
+
+	station_t s;
+	CHECK(radioB.getTuned(s));
+	CHECK_EQ(s.freq, 10700);
+	CHECK_EQ(s.rssi, 30);
+}
+
+int main()
+{
+	return unit::run();
+}
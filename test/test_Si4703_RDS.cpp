@@ -0,0 +1,195 @@
+/*
+ *  Si4703_RDS decoder tests
+ */
+
+#include "unit.h"
+#include "Si4703_RDS.h"
+
+static rdsGroup_t group(uint16_t a, uint16_t b, uint16_t c, uint16_t d,
+						uint8_t ea = BLER_NONE, uint8_t eb = BLER_NONE, uint8_t ec = BLER_NONE, uint8_t ed = BLER_NONE)
+{
+	rdsGroup_t g = { { a, b, c, d }, { ea, eb, ec, ed } };
+	return g;
+}
+
+static void sendPS(Si4703_RDS &rds, uint16_t pi, const char *ps, uint16_t flags = 0)
+{
+	for (int seg = 0; seg < 4; seg++)
+		rds.decode(group(pi, flags | seg, 0, (ps[seg * 2] << 8) | ps[seg * 2 + 1]));
+}
+
+TEST(empty_after_reset)
+{
+	Si4703_RDS rds;
+	CHECK_EQ(rds.getPI(), 0);
+	CHECK(!rds.hasPS());
+	CHECK(!rds.hasRT());
+	CHECK(!rds.hasCT());
+	int y, m, d;
+	CHECK(!rds.getDate(y, m, d));
+}
+
+TEST(basic_information)
+{
+	Si4703_RDS rds;
+	// 0A: TP=1, PTY=10, TA=1, MS=1, segment 0
+	CHECK(rds.decode(group(0xC201, (1 << 10) | (10 << 5) | (1 << 4) | (1 << 3), 0, 0x4142)));
+	CHECK_EQ(rds.getPI(), 0xC201);
+	CHECK(rds.getTP());
+	CHECK_EQ(rds.getPTY(), 10);
+	CHECK(rds.getTA());
+	CHECK(rds.getMS());
+	CHECK_EQ(rds.getGroupType(), 0);
+	CHECK(!rds.getGroupVersion());
+}
+
+TEST(program_service_name)
+{
+	Si4703_RDS rds;
+	sendPS(rds, 0x1234, "RADIO\x01""1 ");
+	CHECK(rds.hasPS());
+	CHECK(strcmp(rds.getPS(), "RADIO 1 ") == 0);			// Control code becomes a space
+
+	rds.decode(group(0x1234, 0, 0, 0x5858));				// Next PS partly received
+	CHECK(strcmp(rds.getPS(), "RADIO 1 ") == 0);			// Old one stays until complete
+}
+
+TEST(radiotext_2A)
+{
+	Si4703_RDS rds;
+	rds.decode(group(0x1234, 0x2000 | 0, 0x4865, 0x6C6C));	// "Hell"
+	CHECK(!rds.hasRT());
+	rds.decode(group(0x1234, 0x2000 | 1, 0x6F0D, 0x0000));	// "o" + end
+	CHECK(rds.hasRT());
+	CHECK(strcmp(rds.getRT(), "Hello") == 0);
+	CHECK_EQ(rds.getGroupType(), 2);
+}
+
+TEST(radiotext_AB_toggle_clears)
+{
+	Si4703_RDS rds;
+	rds.decode(group(0x1234, 0x2000 | 0, 0x4142, 0x0D00));
+	CHECK(strcmp(rds.getRT(), "AB") == 0);
+	rds.decode(group(0x1234, 0x2000 | 0x10 | 1, 0x5859, 0x5A0D));	// Text B, segment 1
+	CHECK(!rds.hasRT());									// Segment 0 of the new text missing
+	CHECK(strncmp(rds.getRT(), "    XYZ", 7) == 0);
+}
+
+TEST(radiotext_2B)
+{
+	Si4703_RDS rds;
+	rds.decode(group(0x1234, 0x2800 | 0, 0x1234, 0x4F4B));	// "OK"
+	rds.decode(group(0x1234, 0x2800 | 1, 0x1234, 0x0D00));
+	CHECK(rds.hasRT());
+	CHECK(strcmp(rds.getRT(), "OK") == 0);
+	CHECK(rds.getGroupVersion());
+}
+
+TEST(clock_time)
+{
+	Si4703_RDS rds;
+	long mjd = 59215;										// 2021-01-01
+	uint16_t b = 0x4000 | ((mjd >> 15) & 0x03);
+	uint16_t c = ((mjd & 0x7FFF) << 1) | (13 >> 4);			// 13:45 UTC
+	uint16_t d = ((13 & 0x0F) << 12) | (45 << 6) | 0x20 | 2;	// -1 hour
+	CHECK(rds.decode(group(0x1234, b, c, d)));
+	CHECK(rds.hasCT());
+
+	int year, month, day, hour, minute, offset;
+	CHECK(rds.getDate(year, month, day));
+	CHECK_EQ(year, 2021);
+	CHECK_EQ(month, 1);
+	CHECK_EQ(day, 1);
+	CHECK(rds.getTime(hour, minute, offset));
+	CHECK_EQ(hour, 13);
+	CHECK_EQ(minute, 45);
+	CHECK_EQ(offset, -60);
+}
+
+TEST(block_errors)
+{
+	Si4703_RDS rds;
+	CHECK(!rds.decode(group(0x1234, 0, 0, 0x4142, BLER_NONE, BLER_FAIL)));	// Block B lost
+	CHECK_EQ(rds.getPI(), 0);
+
+	CHECK(rds.decode(group(0x1234, 0, 0, 0x4142, BLER_NONE, BLER_1_2, BLER_NONE, BLER_3_5)));
+	CHECK_EQ(rds.getPI(), 0x1234);
+
+	rds.setMaxBLER(BLER_NONE);
+	CHECK(!rds.decode(group(0x1234, 0, 0, 0x4142, BLER_NONE, BLER_1_2)));
+	rds.setMaxBLER(BLER_FAIL);								// Clamped to BLER_3_5
+	CHECK(!rds.decode(group(0x1234, 0, 0, 0x4142, BLER_NONE, BLER_FAIL)));
+	CHECK(rds.decode(group(0x1234, 0, 0, 0x4142, BLER_NONE, BLER_3_5)));
+}
+
+TEST(pi_from_block_C_in_version_B)
+{
+	Si4703_RDS rds;
+	CHECK(rds.decode(group(0x0000, 0x0800, 0x5678, 0x4142, BLER_FAIL)));
+	CHECK_EQ(rds.getPI(), 0x5678);
+}
+
+TEST(new_pi_drops_old_data)
+{
+	Si4703_RDS rds;
+	sendPS(rds, 0x1234, "STATION1");
+	CHECK(rds.hasPS());
+	rds.decode(group(0x4321, 0, 0, 0x4142));
+	CHECK_EQ(rds.getPI(), 0x4321);
+	CHECK(!rds.hasPS());
+
+	rds.reset();
+	CHECK_EQ(rds.getPI(), 0);
+}
+
+static void sendAF(Si4703_RDS &rds, uint16_t pi, uint8_t c1, uint8_t c2, uint8_t ec = BLER_NONE)
+{
+	rds.decode(group(pi, 0x0000, (c1 << 8) | c2, 0x4142, BLER_NONE, BLER_NONE, ec));
+}
+
+TEST(af_method_A)
+{
+	Si4703_RDS rds;
+	sendAF(rds, 0x1234, 224 + 5, 69);					// 5 AFs: 94.4
+	sendAF(rds, 0x1234, 36, 136);						// 91.1, 101.1
+	sendAF(rds, 0x1234, 160, 205);						// 103.5, filler
+	sendAF(rds, 0x1234, 224 + 5, 69);					// Repeated list adds nothing
+	sendAF(rds, 0x1234, 36, 136);
+	CHECK_EQ(rds.getAFCount(), 4);
+	CHECK_EQ(rds.getAF(0), 9440);
+	CHECK_EQ(rds.getAF(1), 9110);
+	CHECK_EQ(rds.getAF(2), 10110);
+	CHECK_EQ(rds.getAF(3), 10350);
+	CHECK_EQ(rds.getAF(4), 0);
+}
+
+TEST(af_method_B_skips_regional)
+{
+	Si4703_RDS rds;
+	sendAF(rds, 0x1234, 224 + 5, 69);					// List of 94.4 (tuned)
+	sendAF(rds, 0x1234, 69, 136);						// 101.1 same program
+	sendAF(rds, 0x1234, 36, 69);						// 91.1 same program
+	sendAF(rds, 0x1234, 160, 69);						// 103.5 regional variant
+	CHECK_EQ(rds.getAFCount(), 3);
+	CHECK_EQ(rds.getAF(0), 9440);
+	CHECK_EQ(rds.getAF(1), 10110);
+	CHECK_EQ(rds.getAF(2), 9110);
+}
+
+TEST(af_errors_and_lf_mf)
+{
+	Si4703_RDS rds;
+	sendAF(rds, 0x1234, 224 + 2, 69);
+	sendAF(rds, 0x1234, 36, 136, BLER_FAIL);			// Block C rejected
+	sendAF(rds, 0x1234, 250, 20);						// LF/MF follows
+	rds.decode(group(0x1234, 0x0800, (36 << 8) | 136, 0x4142));	// 0B: block C is the PI
+	CHECK_EQ(rds.getAFCount(), 1);
+
+	rds.decode(group(0x4321, 0, 0, 0x4142));			// New program
+	CHECK_EQ(rds.getAFCount(), 0);
+}
+
+int main()
+{
+	return unit::run();
+}
@@ -0,0 +1,227 @@
+/*
+ *  Si4703_RDSStats: RDS reception statistics per channel
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703.h"
+
+static Si4703Sim sim;					// RST pin 4, SDIO A4, GPIO2 on pin 3
+
+static rdsGroup_t group(uint8_t ea, uint8_t eb, uint8_t ec, uint8_t ed)
+{
+	rdsGroup_t g = { { 0x1234, 0x0000, 0xE0CD, 0x4142 }, { ea, eb, ec, ed } };
+	return g;
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture: PS "ABCDEFGH" on 94.4, errors in block C of 2 of 4 groups, 101.1 without RDS
+//------------------------------------------------------------------------------------------------------------
+static void setup(void)
+{
+	static const char ps[] = "ABCDEFGH";
+
+	host::reset();
+	Wire.reset();
+	sim.reset();
+	sim.connect();
+	sim.addStation(9440, 40);
+	sim.addStation(10110, 35);
+	for (int seg = 0; seg < 4; seg++)
+		sim.addGroup(9440, 0x1234, 0x0000 | seg, 0xE0CD, (ps[seg * 2] << 8) | ps[seg * 2 + 1],
+					 BLER_NONE, BLER_NONE, seg == 2 ? BLER_1_2 : seg == 3 ? BLER_3_5 : BLER_NONE, BLER_NONE);
+}
+
+// Run loop() for ms reading RDS
+static void run(Si4703 &radio, unsigned long ms)
+{
+	unsigned long t = millis();
+	while (millis() - t < ms)
+	{
+		radio.readRDS();
+		delay(20);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Counting
+//------------------------------------------------------------------------------------------------------------
+TEST(nothing_before_tune)
+{
+	Si4703_RDSStats stats;
+	stats.group(group(0, 0, 0, 0), false);
+	stats.sync(true);
+	CHECK_EQ(stats.getCount(), 0);
+	CHECK(stats.get(9440) == NULL);
+	CHECK_EQ(stats.getErrorRate(9440, BLER_NONE), 0);
+	CHECK_EQ(stats.getGroupRate(9440), 0);
+}
+
+TEST(error_levels_and_sync_loss)
+{
+	host::reset();
+	Si4703_RDSStats stats;
+	stats.tuned(9440);
+	stats.group(group(BLER_NONE, BLER_NONE, BLER_NONE, BLER_NONE), false);
+	stats.group(group(BLER_NONE, BLER_1_2, BLER_3_5, BLER_FAIL), false);
+	CHECK_EQ(stats.getErrorRate(9440, BLER_NONE), 63);			// 5 of 8 blocks
+	CHECK_EQ(stats.getErrorRate(9440, BLER_1_2), 13);
+	CHECK_EQ(stats.getErrorRate(9440, BLER_FAIL), 13);
+
+	stats.sync(false);											// Not synchronized yet: no loss
+	stats.sync(true);
+	stats.sync(true);
+	stats.sync(false);
+	stats.sync(true);
+	stats.sync(false);
+	CHECK_EQ(stats.get(9440)->syncLoss, 2);
+	CHECK_EQ(stats.get(9440)->groups, 2);
+}
+
+TEST(time_on_channel_and_ps)
+{
+	host::reset();
+	Si4703_RDSStats stats;
+	stats.tuned(9440);
+	delay(300);
+	stats.group(group(0, 0, 0, 0), false);
+	delay(100);
+	stats.group(group(0, 0, 0, 0), true);						// PS complete 400ms after the tune
+	delay(100);
+	stats.group(group(0, 0, 0, 0), true);
+	delay(500);
+	CHECK_EQ(stats.get(9440)->psTime, 400);
+	CHECK_EQ(stats.get(9440)->psFound, 1);
+	CHECK_EQ(stats.getGroupRate(9440), 30);					// 3 groups in 1 s
+
+	stats.tuned(10110);											// Time of 94.4 stops
+	delay(1000);
+	CHECK_EQ(stats.get(9440)->time, 1000);
+	CHECK_EQ(stats.get(10110)->time, 1000);
+	CHECK_EQ(stats.get(10110)->psTime, 0);
+
+	stats.tuned(9440);											// Back: counts go on
+	CHECK_EQ(stats.get(9440)->tunes, 2);
+	CHECK_EQ(stats.get(9440)->groups, 3);
+	CHECK_EQ(stats.get(9440)->psTime, 0);						// None since this tune yet
+}
+
+TEST(table_replaces_least_recent)
+{
+	host::reset();
+	Si4703_RDSStats stats;
+	for (int i = 0; i < SI4703_RDS_STATS_CHANNELS; i++)
+	{
+		stats.tuned(8800 + 100 * i);
+		delay(10);
+	}
+	stats.tuned(8800);											// Used again
+	delay(10);
+	CHECK_EQ(stats.getCount(), SI4703_RDS_STATS_CHANNELS);
+
+	stats.tuned(10500);
+	CHECK_EQ(stats.getCount(), SI4703_RDS_STATS_CHANNELS);
+	CHECK(stats.get(8900) == NULL);								// Oldest replaced
+	CHECK(stats.get(8800) != NULL);
+	CHECK(stats.get(10500) != NULL);
+	CHECK_EQ(stats.getFreq(1), 10500);
+	CHECK_EQ(stats.getFreq(SI4703_RDS_STATS_CHANNELS), 0);
+}
+
+TEST(rates_of_long_counts)
+{
+	host::reset();
+	Si4703_RDSStats stats;
+	stats.tuned(9440);
+	for (long i = 0; i < 11000000L; i++)						// 44M blocks, 11 days at 11.4 groups/s
+		stats.group(group(BLER_NONE, BLER_NONE, BLER_NONE, i % 10 ? BLER_NONE : BLER_FAIL), false);
+	delay(11000000UL / 114 * 10000);
+	CHECK_EQ(stats.getErrorRate(9440, BLER_NONE), 98);			// 39 of 40 blocks
+	CHECK_EQ(stats.getErrorRate(9440, BLER_FAIL), 3);
+	CHECK_EQ(stats.getGroupRate(9440), 114);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Collected by the driver
+//------------------------------------------------------------------------------------------------------------
+// Bus bytes of a tune and 10s of readRDS(), with or without statistics
+static unsigned long traffic(Si4703_RDSStats *stats)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setRDSStats(stats);
+
+	unsigned long bytes = Wire.bytesRead + Wire.bytesWritten;
+	radio.setChannel(9440);
+	run(radio, 10000);
+	return Wire.bytesRead + Wire.bytesWritten - bytes;
+}
+
+TEST(collected_from_readRDS)
+{
+	Si4703_RDSStats stats;
+	unsigned long bytes = traffic(&stats);
+
+	const rdsStats_t *s = stats.get(9440);
+	CHECK(s != NULL);
+	CHECK_EQ(s->tunes, 1);
+	CHECK(s->groups >= 112 && s->groups <= 114);				// One per 87.6ms
+	CHECK(stats.getGroupRate(9440) >= 112 && stats.getGroupRate(9440) <= 114);
+	CHECK_EQ(stats.getErrorRate(9440, BLER_NONE), 88);			// 14 of 16 blocks per PS
+	CHECK_EQ(stats.getErrorRate(9440, BLER_1_2), 6);
+	CHECK_EQ(stats.getErrorRate(9440, BLER_3_5), 6);
+	CHECK(s->psTime >= 4 * 87 && s->psTime <= 4 * 88 + 20);	// 4 groups after the tune
+	CHECK_EQ(s->syncLoss, 0);
+
+	CHECK_EQ(bytes, traffic(NULL));								// No extra bus traffic
+}
+
+TEST(rds_interrupt_no_stale_groups)
+{
+	setup();
+	Si4703 radio(4, A4, A5, 3);
+	radio.start();
+	Si4703_RDSStats stats;
+	radio.setRDSStats(&stats);
+	radio.setChannel(9440);
+	radio.setRDSInterrupt(true);
+	delay(600);													// Groups of 94.4 queued
+
+	radio.setChannel(10110);									// No RDS
+	run(radio, 1000);
+	CHECK_EQ(stats.get(10110)->groups, 0);
+	CHECK_EQ(stats.get(10110)->psFound, 0);
+	CHECK_EQ(stats.get(9440)->groups, 0);						// Never read on 94.4
+}
+
+TEST(sync_loss_and_seek)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	Si4703_RDSStats stats;
+	radio.setRDSStats(&stats);
+	radio.setChannel(9440);
+	run(radio, 1000);
+
+	sim.rdsLost = true;											// Multipath
+	run(radio, 500);
+	sim.rdsLost = false;
+	run(radio, 1000);
+	CHECK_EQ(stats.get(9440)->syncLoss, 1);
+
+	CHECK_EQ(radio.seekUp(), 10110);
+	run(radio, 1000);
+	CHECK_EQ(stats.getCount(), 2);
+	CHECK_EQ(stats.get(10110)->groups, 0);
+	CHECK_EQ(stats.getGroupRate(10110), 0);
+	CHECK(stats.get(9440)->time >= 2500 && stats.get(9440)->time <= 2500 + 60);	// Not the seek
+}
+
+int main()
+{
+	return unit::run();
+}
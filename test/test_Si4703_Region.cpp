@@ -0,0 +1,210 @@
+/*
+ *  Region policies: runtime region, compile-time regions and a driver with a fixed region
+ */
+
+#include "unit.h"
+#include "host.h"
+#include "Wire.h"
+#include "Si4703Sim.h"
+#include "Si4703.h"
+
+static Si4703Sim sim;					// RST pin 4, SDIO A4, GPIO2 on pin 3
+
+typedef Si4703_Region<BAND_US_EU, SPACE_100KHz, DE_75us>	RegionUS;
+typedef Si4703_Region<BAND_JP,    SPACE_50KHz,  DE_50us>	RegionJP50;
+
+// Constants are usable at compile time
+static_assert(RegionUS::START == 8750 && RegionUS::END == 10800 && RegionUS::SPACING == 10, "US/EU band");
+static_assert(RegionUS::CHANNELS == 206, "US/EU channels");
+static_assert(RegionJP50::freq(RegionJP50::CHANNELS - 1) == 9000, "Japan top of band");
+static_assert(RegionUS::Freq<9440>::chan == 69, "channel of 94.4 MHz");
+
+//------------------------------------------------------------------------------------------------------------
+// Fixture
+//------------------------------------------------------------------------------------------------------------
+static void setup(void)
+{
+	host::reset();
+	Wire.reset();
+	sim.reset();
+	sim.connect();
+	sim.addStation(8810, 40);
+	sim.addStation(9440, 50, false);
+	sim.addStation(10110, 35);
+}
+
+// Fixed region chan()/freq() against the runtime region (division) on every channel
+template <uint8_t BAND, uint8_t SPACE>
+static int checkRegion(void)
+{
+	typedef Si4703_Region<BAND, SPACE, DE_75us> Fixed;
+	Si4703_RuntimeRegion runtime;
+	runtime.set(BAND, SPACE, DE_75us);
+
+	int bad = 0;
+	if (Fixed::start() != runtime.start() || Fixed::end() != runtime.end() ||
+		Fixed::spacing() != runtime.spacing())
+		bad++;
+	for (int f = Fixed::START; f <= Fixed::END; f++)	// Also off-grid frequencies round down
+	{
+		if (Fixed::chan(f) != runtime.chan(f)) bad++;
+		if (Fixed::freq(runtime.chan(f)) != runtime.freq(runtime.chan(f))) bad++;
+	}
+	return bad;
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Regions
+//------------------------------------------------------------------------------------------------------------
+TEST(runtime_region_default)
+{
+	Si4703_RuntimeRegion region;
+	CHECK_EQ(region.band(), BAND_US_EU);
+	CHECK_EQ(region.space(), SPACE_100KHz);
+	CHECK_EQ(region.de(), DE_75us);
+	CHECK_EQ(region.start(), 8750);
+	CHECK_EQ(region.end(), 10800);
+	CHECK_EQ(region.spacing(), 10);
+}
+
+TEST(runtime_region_set)
+{
+	Si4703_RuntimeRegion region;
+	region.set(BAND_JP, SPACE_50KHz, DE_50us);
+	CHECK_EQ(region.start(), 7600);
+	CHECK_EQ(region.end(), 9000);
+	CHECK_EQ(region.spacing(), 5);
+	CHECK_EQ(region.chan(8000), 80);
+	CHECK_EQ(region.freq(80), 8000);
+	CHECK_EQ(region.de(), DE_50us);
+}
+
+TEST(fixed_matches_runtime_all_regions)
+{
+	CHECK_EQ((checkRegion<BAND_US_EU, SPACE_200KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_US_EU, SPACE_100KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_US_EU, SPACE_50KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_JPW,   SPACE_200KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_JPW,   SPACE_100KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_JPW,   SPACE_50KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_JP,    SPACE_200KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_JP,    SPACE_100KHz>()), 0);
+	CHECK_EQ((checkRegion<BAND_JP,    SPACE_50KHz>()), 0);
+}
+
+//------------------------------------------------------------------------------------------------------------
+// Driver with a fixed region
+//------------------------------------------------------------------------------------------------------------
+TEST(fixed_start_sets_region)
+{
+	setup();
+	Si4703_Fixed<BAND_JPW, SPACE_50KHz, DE_50us> radio;
+
+	CHECK_EQ(radio.start(), Si4703::ERR_NONE);
+	CHECK_EQ((sim.reg(0x05) >> 6) & 0x3, BAND_JPW);		// BAND
+	CHECK_EQ((sim.reg(0x05) >> 4) & 0x3, SPACE_50KHz);		// SPACE
+	CHECK(sim.reg(0x04) & 0x0800);							// DE
+	CHECK_EQ(radio.getBandStart(), 7600);
+	CHECK_EQ(radio.getBandEnd(), 10800);
+	CHECK_EQ(radio.getBandSpace(), 5);
+}
+
+TEST(fixed_ignores_constructor_region)
+{
+	setup();
+	Si4703_Fixed<BAND_US_EU, SPACE_100KHz, DE_75us> radio(4, A4, A5, 0, BAND_JP, SPACE_50KHz, DE_50us);
+
+	radio.start();
+	CHECK_EQ(radio.getBandStart(), 8750);
+	CHECK_EQ((sim.reg(0x05) >> 6) & 0x3, BAND_US_EU);
+}
+
+TEST(fixed_tune_seek)
+{
+	setup();
+	Si4703_Fixed<BAND_US_EU, SPACE_100KHz, DE_75us> radio;
+	radio.start();
+
+	CHECK_EQ(radio.setChannel(9440), 9440);
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK_EQ(sim.reg(0x03) & 0x3FF, 69);					// CHAN
+	CHECK_EQ(radio.setChannel<10110>(), 10110);
+	CHECK_EQ(radio.getRSSI(), 35);
+	CHECK_EQ(radio.decChannel(), 10100);
+	CHECK_EQ(radio.incChannel(), 10110);
+	CHECK_EQ(radio.setChannel(12000), 10800);				// Clamped to the band
+	CHECK_EQ(radio.setChannel(8000), 8750);
+	CHECK_EQ(radio.seekUp(), 8810);
+}
+
+TEST(fixed_and_runtime_agree)
+{
+	setup();
+	Si4703_Fixed<BAND_US_EU, SPACE_200KHz, DE_75us> fixed;
+	fixed.start();
+	uint16_t chanFixed[3];
+	int      freqs[3] = { 8810, 9450, 10790 };
+	for (int i = 0; i < 3; i++)
+	{
+		fixed.setChannel(freqs[i]);
+		chanFixed[i] = sim.reg(0x03) & 0x3FF;
+	}
+
+	setup();
+	Si4703 runtime(4, A4, A5, 0, BAND_US_EU, SPACE_200KHz, DE_75us);
+	runtime.start();
+	for (int i = 0; i < 3; i++)
+	{
+		CHECK_EQ(runtime.setChannel(freqs[i]), fixed.getBandStart() + chanFixed[i] * 20);
+		CHECK_EQ(sim.reg(0x03) & 0x3FF, chanFixed[i]);
+	}
+}
+
+TEST(runtime_setChannel_template)
+{
+	setup();
+	Si4703 radio;
+	radio.start();
+	CHECK_EQ(radio.setChannel<8810>(), 8810);				// Not checked, but same call
+	CHECK_EQ(radio.getRSSI(), 40);
+}
+
+TEST(restoreState_region)
+{
+	setup();
+	Si4703 jp(4, A4, A5, 0, BAND_JP, SPACE_50KHz, DE_50us);
+	jp.start();
+	jp.setChannel(8810);
+	uint8_t profile[Si4703::STATE_SIZE];
+	jp.saveState(profile);
+
+	setup();
+	Si4703 radio;
+	radio.start();
+	radio.setChannel(9440);
+	CHECK_EQ(radio.restoreState(profile), Si4703::ERR_NONE);	// Runtime region takes the band
+	CHECK_EQ(radio.getBandStart(), 7600);
+	CHECK_EQ(radio.getBandEnd(), 9000);
+	CHECK_EQ(radio.getBandSpace(), 5);
+	CHECK_EQ(radio.getChannel(), 8810);
+	CHECK_EQ(sim.freq(), 8810);
+	CHECK(sim.reg(0x04) & 0x0800);							// DE
+
+	setup();
+	Si4703_Fixed<BAND_US_EU, SPACE_100KHz, DE_75us> fixed;
+	fixed.start();
+	fixed.setChannel(9440);
+	CHECK_EQ(fixed.restoreState(profile), Si4703::ERR_STATE);	// Another band
+	CHECK_EQ(sim.freq(), 9440);
+	CHECK_EQ(fixed.getBandStart(), 8750);
+
+	fixed.saveState(profile);
+	fixed.setChannel(10110);
+	CHECK_EQ(fixed.restoreState(profile), Si4703::ERR_NONE);
+	CHECK_EQ(sim.freq(), 9440);
+}
+
+int main()
+{
+	return unit::run();
+}
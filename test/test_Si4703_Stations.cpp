@@ -0,0 +1,148 @@
+/*
+ *  Si4703_Stations table tests
+ */
+
+#include "unit.h"
+#include "Si4703.h"
+
+//------------------------------------------------------------------------------------------------------------
+// EEPROM stand-in
+//------------------------------------------------------------------------------------------------------------
+struct Storage
+{
+	uint8_t		mem[256];
+	int			writes;
+
+	Storage()							{ memset(mem, 0xFF, sizeof(mem)); writes = 0; }
+	uint8_t		read(int addr)			{ return mem[addr]; }
+	void		write(int addr, uint8_t v)	{ mem[addr] = v; writes++; }
+};
+
+static void fill(Si4703_Stations &t)
+{
+	t.setRegion(BAND_US_EU, SPACE_100KHz, DE_75us);
+	t.add(8810, 40, true, 0xC201);
+	t.add(9440, 50, false, 0);
+	t.setLast(9440);
+	t.setVolume(7);
+}
+
+TEST(add_count_getFreq)
+{
+	Si4703_Stations t;
+	CHECK_EQ(t.count(), 0);
+	CHECK_EQ(t.capacity(), SI4703_STATIONS_MAX);
+	CHECK(t.add(8810));
+	CHECK_EQ(t.count(), 1);
+	CHECK_EQ(t.getFreq(0), 8810);
+	CHECK_EQ(t.getFreq(1), 0);
+	CHECK_EQ(t.getFreq(-1), 0);
+	CHECK_EQ(t.list()[0].freq, 8810);
+
+	for (int i = 1; i < SI4703_STATIONS_MAX; i++) CHECK(t.add(8800 + i * 10));
+	CHECK(!t.add(10000));									// Full
+}
+
+TEST(setCount_clamps)
+{
+	Si4703_Stations t;
+	t.setCount(-3);
+	CHECK_EQ(t.count(), 0);
+	t.setCount(SI4703_STATIONS_MAX + 5);
+	CHECK_EQ(t.count(), SI4703_STATIONS_MAX);
+}
+
+TEST(last_volume_clear)
+{
+	Si4703_Stations t;
+	fill(t);
+	CHECK_EQ(t.getLast(), 9440);
+	CHECK_EQ(t.getVolume(), 7);
+	t.clear();
+	CHECK_EQ(t.count(), 0);
+	CHECK_EQ(t.getLast(), 0);
+	CHECK_EQ(t.getVolume(), 0);
+}
+
+TEST(save_load_roundtrip)
+{
+	Si4703_Stations t;
+	fill(t);
+	Storage ee;
+	CHECK_EQ(t.size(), 7 + 2 * 5 + 2);
+	CHECK_EQ(t.save(ee, 10), t.size());
+
+	Si4703_Stations u;
+	u.setRegion(BAND_US_EU, SPACE_100KHz, DE_75us);
+	CHECK(u.load(ee, 10));
+	CHECK_EQ(u.count(), 2);
+	CHECK_EQ(u.getFreq(0), 8810);
+	CHECK_EQ(u.list()[0].rssi, 40);
+	CHECK(u.list()[0].st);
+	CHECK_EQ(u.list()[0].pi, 0xC201);
+	CHECK_EQ(u.getFreq(1), 9440);
+	CHECK_EQ(u.getLast(), 9440);
+	CHECK_EQ(u.getVolume(), 7);
+}
+
+TEST(save_skips_unchanged_bytes)
+{
+	Si4703_Stations t;
+	fill(t);
+	Storage ee;
+	t.save(ee);
+	int first = ee.writes;
+	t.save(ee);
+	CHECK_EQ(ee.writes, first);								// Nothing written again
+	t.setVolume(8);
+	t.save(ee);
+	CHECK_EQ(ee.writes, first + 3);							// Volume + 2 CRC bytes
+}
+
+TEST(load_rejects_bad_data)
+{
+	Si4703_Stations t;
+	fill(t);
+	Storage ee;
+	t.save(ee);
+
+	Si4703_Stations u;
+	u.setRegion(BAND_US_EU, SPACE_100KHz, DE_75us);
+
+	Storage blank;
+	CHECK(!u.load(blank));									// Missing
+
+	Storage corrupt = ee;
+	corrupt.mem[9] ^= 0x01;
+	CHECK(!u.load(corrupt));								// CRC
+	CHECK_EQ(u.count(), 0);
+
+	Storage version = ee;
+	version.mem[1] = Si4703_Stations::VERSION + 1;
+	CHECK(!u.load(version));								// Other layout
+
+	Si4703_Stations eu;
+	eu.setRegion(BAND_US_EU, SPACE_100KHz, DE_50us);
+	CHECK(!eu.load(ee));									// Other region
+}
+
+TEST(default_region_of_driver)
+{
+	Storage ee;
+	Si4703_Stations t;										// No setRegion()
+	t.add(9440);
+	t.save(ee);
+	CHECK_EQ(ee.mem[2], SPACE_100KHz << 2);					// BAND_US_EU, SPACE_100KHz, DE_75us
+
+	Si4703_Stations u;
+	u.setRegion(BAND_US_EU, SPACE_100KHz, DE_75us);
+	CHECK(u.load(ee));
+	Si4703_Stations us;
+	us.setRegion(BAND_US_EU, SPACE_200KHz, DE_75us);
+	CHECK(!us.load(ee));
+}
+
+int main()
+{
+	return unit::run();
+}
@@ -0,0 +1,85 @@
+/*
+ *  Minimal unit test runner for the host tests
+ *
+ *  TEST(name) { CHECK(cond); CHECK_EQ(a, b); }
+ *  int main() { return unit::run(); }
+ */
+
+#ifndef unit_h
+#define unit_h
+
+#include <stdio.h>
+
+namespace unit
+{
+	typedef void (*test_t)(void);
+
+	struct Test
+	{
+		const char	*name;
+		test_t		fn;
+		Test		*next;
+	};
+
+	inline Test*&	first(void)		{ static Test *t = 0; return t; }
+	inline int&		failures(void)	{ static int n = 0; return n; }
+
+	struct Add
+	{
+		Add(Test *t)
+		{
+			Test **p = &first();
+			while (*p) p = &(*p)->next;
+			*p = t;
+		}
+	};
+
+	inline bool check(bool ok, const char *file, int line, const char *expr)
+	{
+		if (!ok)
+		{
+			printf("  %s:%d: CHECK(%s) failed\n", file, line, expr);
+			failures()++;
+		}
+		return ok;
+	}
+
+	inline bool checkEq(long long a, long long b, const char *file, int line, const char *ea, const char *eb)
+	{
+		if (a != b)
+		{
+			printf("  %s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", file, line, ea, eb, a, b);
+			failures()++;
+		}
+		return a == b;
+	}
+
+	inline int run(void)
+	{
+		int tests = 0, failed = 0;
+		for (Test *t = first(); t; t = t->next)
+		{
+			int before = failures();
+			t->fn();
+			tests++;
+			if (failures() != before)
+			{
+				printf("FAIL %s\n", t->name);
+				failed++;
+			}
+		}
+		printf("%d tests, %d failed\n", tests, failed);
+		return failed ? 1 : 0;
+	}
+}
+
+#define TEST(name)																\
+	static void test_##name(void);												\
+	static unit::Test	unitTest_##name = { #name, test_##name, 0 };			\
+	static unit::Add	unitAdd_##name(&unitTest_##name);						\
+	static void test_##name(void)
+
+#define CHECK(cond)			unit::check((cond), __FILE__, __LINE__, #cond)
+#define CHECK_EQ(a, b)		unit::checkEq((long long)(a), (long long)(b), __FILE__, __LINE__, #a, #b)
+
+#endif